@@ -1,6 +1,6 @@
 /*
  *	 Copyright (C) 2012 by Ian Wraith
- *   Copyright (C) 2015,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,25 +19,78 @@
 
 #include "BPTC19696.h"
 
-#include "Hamming.h"
-#include "Utils.h"
-
-#include <cstdio>
 #include <cassert>
 #include <cstring>
 
+// Where a bit of the matrix is carried in the frame
+struct CBPTCPosition {
+	unsigned char m_byte;
+	unsigned char m_shift;
+};
+
+struct CBPTCTables {
+	CBPTCTables();
+
+	CBPTCPosition m_positions[13U][15U];
+
+	// The Hamming (15,11,3) parity bits for the 11 data bits of a row, in the order that they follow the data
+	unsigned char m_parity15113[2048U];
+};
+
+static const CBPTCTables TABLES;
+
+// The bit of a row to flip for each Hamming (15,11,3) syndrome
+static const unsigned short FIX_15113[] = {
+	0x0000U, 0x0008U, 0x0004U, 0x0040U, 0x0002U, 0x0200U, 0x0020U, 0x0800U,
+	0x0001U, 0x4000U, 0x0100U, 0x2000U, 0x0010U, 0x0080U, 0x0400U, 0x1000U};
+
+// The row to flip for each Hamming (13,9,3) syndrome that can be corrected, 0x09 and 0x0B can't be
+static const unsigned char FIX_1393_SYNDROMES[] = {0x01U, 0x02U, 0x04U, 0x08U, 0x0FU, 0x07U, 0x0EU, 0x05U, 0x0AU, 0x0DU, 0x03U, 0x06U, 0x0CU};
+static const unsigned char FIX_1393_ROWS[]      = {9U,    10U,   11U,   12U,   0U,    1U,    2U,    3U,    4U,    5U,    6U,    7U,    8U};
+
+const unsigned short ROW_MASK = 0x7FFFU;
+
+CBPTCTables::CBPTCTables()
+{
+	// Bit a of the deinterleaved matrix is bit (a * 181) % 196 as it is carried, the data is split around
+	// the slot type and sync. Bit 0 is the unused R(3) bit, and the matrix starts after it.
+	for (unsigned int a = 1U; a < 196U; a++) {
+		unsigned int n = (a * 181U) % 196U;
+
+		CBPTCPosition& position = m_positions[(a - 1U) / 15U][(a - 1U) % 15U];
+		if (n < 98U) {
+			position.m_byte  = n / 8U;
+			position.m_shift = 7U - (n % 8U);
+		} else if (n < 100U) {
+			position.m_byte  = 20U;
+			position.m_shift = 99U - n;
+		} else {
+			position.m_byte  = 21U + (n - 100U) / 8U;
+			position.m_shift = 7U - ((n - 100U) % 8U);
+		}
+	}
+
+	for (unsigned int data = 0U; data < 2048U; data++) {
+		bool d[11U];
+		for (unsigned int i = 0U; i < 11U; i++)
+			d[i] = (data & (0x400U >> i)) != 0U;
+
+		unsigned char parity = 0x00U;
+		parity |= (d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8])  ? 0x08U : 0x00U;
+		parity |= (d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9])  ? 0x04U : 0x00U;
+		parity |= (d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10]) ? 0x02U : 0x00U;
+		parity |= (d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10]) ? 0x01U : 0x00U;
+		m_parity15113[data] = parity;
+	}
+}
+
 CBPTC19696::CBPTC19696() :
-m_rawData(nullptr),
-m_deInterData(nullptr)
+m_rows()
 {
-	m_rawData     = new bool[196];
-	m_deInterData = new bool[196];
 }
 
 CBPTC19696::~CBPTC19696()
 {
-	delete[] m_rawData;
-	delete[] m_deInterData;
 }
 
 // The main decode function
@@ -46,12 +99,9 @@ void CBPTC19696::decode(const unsigned char* in, unsigned char* out)
 	assert(in != nullptr);
 	assert(out != nullptr);
 
-	//  Get the raw binary
+	//  Get the raw binary and deinterleave it
 	decodeExtractBinary(in);
 
-	// Deinterleave
-	decodeDeInterleave();
-
 	// Error check
 	decodeErrorCheck();
 
@@ -71,66 +121,23 @@ void CBPTC19696::encode(const unsigned char* in, unsigned char* out)
 	// Error check
 	encodeErrorCheck();
 
-	// Deinterleave
-	encodeInterleave();
-
-	//  Get the raw binary
+	// Interleave and get the raw binary
 	encodeExtractBinary(out);
 }
 
 void CBPTC19696::decodeExtractBinary(const unsigned char* in)
 {
-	// First block
-	CUtils::byteToBitsBE(in[0U],  m_rawData + 0U);
-	CUtils::byteToBitsBE(in[1U],  m_rawData + 8U);
-	CUtils::byteToBitsBE(in[2U],  m_rawData + 16U);
-	CUtils::byteToBitsBE(in[3U],  m_rawData + 24U);
-	CUtils::byteToBitsBE(in[4U],  m_rawData + 32U);
-	CUtils::byteToBitsBE(in[5U],  m_rawData + 40U);
-	CUtils::byteToBitsBE(in[6U],  m_rawData + 48U);
-	CUtils::byteToBitsBE(in[7U],  m_rawData + 56U);
-	CUtils::byteToBitsBE(in[8U],  m_rawData + 64U);
-	CUtils::byteToBitsBE(in[9U],  m_rawData + 72U);
-	CUtils::byteToBitsBE(in[10U], m_rawData + 80U);
-	CUtils::byteToBitsBE(in[11U], m_rawData + 88U);
-	CUtils::byteToBitsBE(in[12U], m_rawData + 96U);
-
-	// Handle the two bits
-	bool bits[8U];
-	CUtils::byteToBitsBE(in[20U], bits);
-	m_rawData[98U] = bits[6U];
-	m_rawData[99U] = bits[7U];
-
-	// Second block
-	CUtils::byteToBitsBE(in[21U], m_rawData + 100U);
-	CUtils::byteToBitsBE(in[22U], m_rawData + 108U);
-	CUtils::byteToBitsBE(in[23U], m_rawData + 116U);
-	CUtils::byteToBitsBE(in[24U], m_rawData + 124U);
-	CUtils::byteToBitsBE(in[25U], m_rawData + 132U);
-	CUtils::byteToBitsBE(in[26U], m_rawData + 140U);
-	CUtils::byteToBitsBE(in[27U], m_rawData + 148U);
-	CUtils::byteToBitsBE(in[28U], m_rawData + 156U);
-	CUtils::byteToBitsBE(in[29U], m_rawData + 164U);
-	CUtils::byteToBitsBE(in[30U], m_rawData + 172U);
-	CUtils::byteToBitsBE(in[31U], m_rawData + 180U);
-	CUtils::byteToBitsBE(in[32U], m_rawData + 188U);
-}
+	for (unsigned int i = 0U; i < 13U; i++) {
+		const CBPTCPosition* positions = TABLES.m_positions[i];
 
-// Deinterleave the raw data
-void CBPTC19696::decodeDeInterleave()
-{
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_deInterData[i] = false;
-
-	// The first bit is R(3) which is not used so can be ignored
-	for (unsigned int a = 0U; a < 196U; a++)	{
-		// Calculate the interleave sequence
-		unsigned int interleaveSequence = (a * 181U) % 196U;
-		// Shuffle the data
-		m_deInterData[a] = m_rawData[interleaveSequence];
+		unsigned int row = 0U;
+		for (unsigned int j = 0U; j < 15U; j++)
+			row = (row << 1) | ((in[positions[j].m_byte] >> positions[j].m_shift) & 0x01U);
+
+		m_rows[i] = row;
 	}
 }
-	
+
 // Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
 void CBPTC19696::decodeErrorCheck()
 {
@@ -139,31 +146,43 @@ void CBPTC19696::decodeErrorCheck()
 	do {
 		fixing = false;
 
-		// Run through each of the 15 columns
-		bool col[13U];
-		for (unsigned int c = 0U; c < 15U; c++) {
-			unsigned int pos = c + 1U;
-			for (unsigned int a = 0U; a < 13U; a++) {
-				col[a] = m_deInterData[pos];
-				pos = pos + 15U;
-			}
+		// The syndromes of all 15 columns at once, a bit for each column
+		unsigned short r[13U];
+		::memcpy(r, m_rows, sizeof(r));
 
-			if (CHamming::decode1393(col)) {
-				unsigned int pos = c + 1U;
-				for (unsigned int a = 0U; a < 13U; a++) {
-					m_deInterData[pos] = col[a];
-					pos = pos + 15U;
-				}
+		unsigned short s0 = r[0U] ^ r[1U] ^ r[3U] ^ r[5U] ^ r[6U] ^ r[9U];
+		unsigned short s1 = r[0U] ^ r[1U] ^ r[2U] ^ r[4U] ^ r[6U] ^ r[7U] ^ r[10U];
+		unsigned short s2 = r[0U] ^ r[1U] ^ r[2U] ^ r[3U] ^ r[5U] ^ r[7U] ^ r[8U] ^ r[11U];
+		unsigned short s3 = r[0U] ^ r[2U] ^ r[4U] ^ r[5U] ^ r[8U] ^ r[12U];
 
-				fixing = true;
+		if ((s0 | s1 | s2 | s3) != 0U) {
+			for (unsigned int i = 0U; i < 13U; i++) {
+				unsigned char syndrome = FIX_1393_SYNDROMES[i];
+
+				unsigned short columns = ROW_MASK;
+				columns &= (syndrome & 0x01U) ? s0 : ~s0;
+				columns &= (syndrome & 0x02U) ? s1 : ~s1;
+				columns &= (syndrome & 0x04U) ? s2 : ~s2;
+				columns &= (syndrome & 0x08U) ? s3 : ~s3;
+
+				if (columns != 0U) {
+					m_rows[FIX_1393_ROWS[i]] ^= columns;
+					fixing = true;
+				}
 			}
 		}
-		
+
 		// Run through each of the 9 rows containing data
-		for (unsigned int r = 0U; r < 9U; r++) {
-			unsigned int pos = (r * 15U) + 1U;
-			if (CHamming::decode15113_2(m_deInterData + pos))
+		for (unsigned int i = 0U; i < 9U; i++) {
+			unsigned short row = m_rows[i];
+
+			unsigned char diff = TABLES.m_parity15113[row >> 4] ^ (row & 0x0FU);
+			if (diff != 0U) {
+				// The syndrome has the first parity bit lowest
+				unsigned char syndrome = ((diff & 0x08U) >> 3) | ((diff & 0x04U) >> 1) | ((diff & 0x02U) << 1) | ((diff & 0x01U) << 3);
+				m_rows[i] ^= FIX_15113[syndrome];
 				fixing = true;
+			}
 		}
 
 		count++;
@@ -173,175 +192,73 @@ void CBPTC19696::decodeErrorCheck()
 // Extract the 96 bits of payload
 void CBPTC19696::decodeExtractData(unsigned char* data) const
 {
-	bool bData[96U];
-	unsigned int pos = 0U;
-	for (unsigned int a = 4U; a <= 11U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 16U; a <= 26U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 31U; a <= 41U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 46U; a <= 56U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 61U; a <= 71U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 76U; a <= 86U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 91U; a <= 101U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 106U; a <= 116U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 121U; a <= 131U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	CUtils::bitsToByteBE(bData + 0U,  data[0U]);
-	CUtils::bitsToByteBE(bData + 8U,  data[1U]);
-	CUtils::bitsToByteBE(bData + 16U, data[2U]);
-	CUtils::bitsToByteBE(bData + 24U, data[3U]);
-	CUtils::bitsToByteBE(bData + 32U, data[4U]);
-	CUtils::bitsToByteBE(bData + 40U, data[5U]);
-	CUtils::bitsToByteBE(bData + 48U, data[6U]);
-	CUtils::bitsToByteBE(bData + 56U, data[7U]);
-	CUtils::bitsToByteBE(bData + 64U, data[8U]);
-	CUtils::bitsToByteBE(bData + 72U, data[9U]);
-	CUtils::bitsToByteBE(bData + 80U, data[10U]);
-	CUtils::bitsToByteBE(bData + 88U, data[11U]);
-}
+	// The first row carries 8 bits after R(2) to R(0), the others 11 bits each
+	unsigned long long bits = (m_rows[0U] >> 4) & 0xFFU;
+	unsigned int count = 8U;
+	unsigned int n = 0U;
+
+	for (unsigned int i = 1U; i < 9U; i++) {
+		bits = (bits << 11) | ((m_rows[i] >> 4) & 0x7FFU);
+		count += 11U;
+
+		while (count >= 8U) {
+			count -= 8U;
+			data[n++] = (unsigned char)(bits >> count);
+		}
+	}
 
-// Extract the 96 bits of payload
-void CBPTC19696::encodeExtractData(const unsigned char* in) const
-{
-	bool bData[96U];
-	CUtils::byteToBitsBE(in[0U],  bData + 0U);
-	CUtils::byteToBitsBE(in[1U],  bData + 8U);
-	CUtils::byteToBitsBE(in[2U],  bData + 16U);
-	CUtils::byteToBitsBE(in[3U],  bData + 24U);
-	CUtils::byteToBitsBE(in[4U],  bData + 32U);
-	CUtils::byteToBitsBE(in[5U],  bData + 40U);
-	CUtils::byteToBitsBE(in[6U],  bData + 48U);
-	CUtils::byteToBitsBE(in[7U],  bData + 56U);
-	CUtils::byteToBitsBE(in[8U],  bData + 64U);
-	CUtils::byteToBitsBE(in[9U],  bData + 72U);
-	CUtils::byteToBitsBE(in[10U], bData + 80U);
-	CUtils::byteToBitsBE(in[11U], bData + 88U);
-
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_deInterData[i] = false;
-
-	unsigned int pos = 0U;
-	for (unsigned int a = 4U; a <= 11U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 16U; a <= 26U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 31U; a <= 41U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 46U; a <= 56U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 61U; a <= 71U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 76U; a <= 86U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 91U; a <= 101U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 106U; a <= 116U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 121U; a <= 131U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+	assert(n == 12U);
 }
 
-// Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
-void CBPTC19696::encodeErrorCheck()
+void CBPTC19696::encodeExtractData(const unsigned char* in)
 {
-	
-	// Run through each of the 9 rows containing data
-	for (unsigned int r = 0U; r < 9U; r++) {
-		unsigned int pos = (r * 15U) + 1U;
-		CHamming::encode15113_2(m_deInterData + pos);
-	}
-	
-	// Run through each of the 15 columns
-	bool col[13U];
-	for (unsigned int c = 0U; c < 15U; c++) {
-		unsigned int pos = c + 1U;
-		for (unsigned int a = 0U; a < 13U; a++) {
-			col[a] = m_deInterData[pos];
-			pos = pos + 15U;
-		}
+	::memset(m_rows, 0x00U, sizeof(m_rows));
+
+	m_rows[0U] = (unsigned short)in[0U] << 4;
 
-		CHamming::encode1393(col);
+	unsigned long long bits = 0ULL;
+	unsigned int count = 0U;
+	unsigned int n = 1U;
 
-		pos = c + 1U;
-		for (unsigned int a = 0U; a < 13U; a++) {
-			m_deInterData[pos] = col[a];
-			pos = pos + 15U;
+	for (unsigned int i = 1U; i < 9U; i++) {
+		while (count < 11U) {
+			bits = (bits << 8) | in[n++];
+			count += 8U;
 		}
+
+		count -= 11U;
+		m_rows[i] = (unsigned short)(((bits >> count) & 0x7FFU) << 4);
 	}
 }
 
-// Interleave the raw data
-void CBPTC19696::encodeInterleave()
+// Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
+void CBPTC19696::encodeErrorCheck()
 {
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_rawData[i] = false;
-
-	// The first bit is R(3) which is not used so can be ignored
-	for (unsigned int a = 0U; a < 196U; a++)	{
-		// Calculate the interleave sequence
-		unsigned int interleaveSequence = (a * 181U) % 196U;
-		// Unshuffle the data
-		m_rawData[interleaveSequence] = m_deInterData[a];
-	}
+	// Run through each of the 9 rows containing data
+	for (unsigned int i = 0U; i < 9U; i++)
+		m_rows[i] |= TABLES.m_parity15113[m_rows[i] >> 4];
+
+	// All 15 columns at once
+	unsigned short* r = m_rows;
+	r[9U]  = r[0U] ^ r[1U] ^ r[3U] ^ r[5U] ^ r[6U];
+	r[10U] = r[0U] ^ r[1U] ^ r[2U] ^ r[4U] ^ r[6U] ^ r[7U];
+	r[11U] = r[0U] ^ r[1U] ^ r[2U] ^ r[3U] ^ r[5U] ^ r[7U] ^ r[8U];
+	r[12U] = r[0U] ^ r[2U] ^ r[4U] ^ r[5U] ^ r[8U];
 }
 
-void CBPTC19696::encodeExtractBinary(unsigned char* data)
+void CBPTC19696::encodeExtractBinary(unsigned char* data) const
 {
-	// First block
-	CUtils::bitsToByteBE(m_rawData + 0U,  data[0U]);
-	CUtils::bitsToByteBE(m_rawData + 8U,  data[1U]);
-	CUtils::bitsToByteBE(m_rawData + 16U, data[2U]);
-	CUtils::bitsToByteBE(m_rawData + 24U, data[3U]);
-	CUtils::bitsToByteBE(m_rawData + 32U, data[4U]);
-	CUtils::bitsToByteBE(m_rawData + 40U, data[5U]);
-	CUtils::bitsToByteBE(m_rawData + 48U, data[6U]);
-	CUtils::bitsToByteBE(m_rawData + 56U, data[7U]);
-	CUtils::bitsToByteBE(m_rawData + 64U, data[8U]);
-	CUtils::bitsToByteBE(m_rawData + 72U, data[9U]);
-	CUtils::bitsToByteBE(m_rawData + 80U, data[10U]);
-	CUtils::bitsToByteBE(m_rawData + 88U, data[11U]);
-
-	// Handle the two bits
-	unsigned char byte;
-	CUtils::bitsToByteBE(m_rawData + 96U, byte);
-	data[12U] = (data[12U] & 0x3FU) | ((byte >> 0) & 0xC0U);
-	data[20U] = (data[20U] & 0xFCU) | ((byte >> 4) & 0x03U);
-
-	// Second block
-	CUtils::bitsToByteBE(m_rawData + 100U,  data[21U]);
-	CUtils::bitsToByteBE(m_rawData + 108U,  data[22U]);
-	CUtils::bitsToByteBE(m_rawData + 116U,  data[23U]);
-	CUtils::bitsToByteBE(m_rawData + 124U,  data[24U]);
-	CUtils::bitsToByteBE(m_rawData + 132U,  data[25U]);
-	CUtils::bitsToByteBE(m_rawData + 140U,  data[26U]);
-	CUtils::bitsToByteBE(m_rawData + 148U,  data[27U]);
-	CUtils::bitsToByteBE(m_rawData + 156U,  data[28U]);
-	CUtils::bitsToByteBE(m_rawData + 164U,  data[29U]);
-	CUtils::bitsToByteBE(m_rawData + 172U,  data[30U]);
-	CUtils::bitsToByteBE(m_rawData + 180U,  data[31U]);
-	CUtils::bitsToByteBE(m_rawData + 188U,  data[32U]);
+	// The unused R(3) bit is always sent as zero, and the slot type and sync are left as they are
+	::memset(data + 0U, 0x00U, 12U);
+	data[12U] &= 0x3FU;
+	data[20U] &= 0xFCU;
+	::memset(data + 21U, 0x00U, 12U);
+
+	for (unsigned int i = 0U; i < 13U; i++) {
+		const CBPTCPosition* positions = TABLES.m_positions[i];
+
+		unsigned int row = m_rows[i];
+		for (unsigned int j = 0U; j < 15U; j++)
+			data[positions[j].m_byte] |= ((row >> (14U - j)) & 0x01U) << positions[j].m_shift;
+	}
 }
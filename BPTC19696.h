@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,6 +19,8 @@
 #if !defined(BPTC19696_H)
 #define	BPTC19696_H
 
+// The 196 bits are held as 13 rows of 15 bits, with column 0 in bit 14 of each row, so that the
+// Hamming codes are worked out a whole row, or a bit of every column, at a time.
 class CBPTC19696
 {
 public:
@@ -30,18 +32,15 @@ public:
 	void encode(const unsigned char* in, unsigned char* out);
 
 private:
-	bool* m_rawData;
-	bool* m_deInterData;
+	unsigned short m_rows[13U];
 
 	void decodeExtractBinary(const unsigned char* in);
 	void decodeErrorCheck();
-	void decodeDeInterleave();
 	void decodeExtractData(unsigned char* data) const;
 
-	void encodeExtractData(const unsigned char* in) const;
-	void encodeInterleave();
+	void encodeExtractData(const unsigned char* in);
 	void encodeErrorCheck();
-	void encodeExtractBinary(unsigned char* data);
+	void encodeExtractBinary(unsigned char* data) const;
 };
 
 #endif
@@ -47,10 +47,20 @@ m_file(file),
 m_id(0U),
 m_daemon(false),
 m_trunkingEnabled(false),
+m_threaded(false),
+m_connectedSockets(false),
+m_pacing(false),
+m_rxOverflow("block"),
+m_realtime(false),
+m_realtimePriority(50U),
+m_realtimeCPUs(),
 m_rptAddress("127.0.0.1"),
 m_rptPort(62032U),
 m_localAddress("127.0.0.1"),
 m_localPort(62031U),
+m_transport("udp"),
+m_rptPath("/tmp/MMDVMHost.sock"),
+m_localPath("/tmp/DMRGateway.sock"),
 m_rfTimeout(10U),
 m_netTimeout(10U),
 m_ruleTrace(false),
@@ -192,6 +202,25 @@ bool CConf::read()
 				m_daemon = ::atoi(value) == 1;
 			else if (::strcmp(key, "TrunkingEnabled") == 0)
 				m_trunkingEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Threaded") == 0)
+				m_threaded = ::atoi(value) == 1;
+			else if (::strcmp(key, "ConnectedSockets") == 0)
+				m_connectedSockets = ::atoi(value) == 1;
+			else if (::strcmp(key, "Pacing") == 0)
+				m_pacing = ::atoi(value) == 1;
+			else if (::strcmp(key, "RxOverflow") == 0)
+				m_rxOverflow = value;
+			else if (::strcmp(key, "Realtime") == 0)
+				m_realtime = ::atoi(value) == 1;
+			else if (::strcmp(key, "RealtimePriority") == 0)
+				m_realtimePriority = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "RealtimeCPUs") == 0) {
+				char* p = ::strtok(value, ", \r\n");
+				while (p != nullptr) {
+					m_realtimeCPUs.push_back((unsigned int)::atoi(p));
+					p = ::strtok(nullptr, ", \r\n");
+				}
+			}
 			else if (::strcmp(key, "Timeout") == 0)
 				m_rfTimeout = m_netTimeout = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "RFTimeout") == 0)
@@ -206,6 +235,12 @@ bool CConf::read()
 				m_localAddress = value;
 			else if (::strcmp(key, "LocalPort") == 0)
 				m_localPort = (unsigned short)::atoi(value);
+			else if (::strcmp(key, "Transport") == 0)
+				m_transport = value;
+			else if (::strcmp(key, "RptPath") == 0)
+				m_rptPath = value;
+			else if (::strcmp(key, "LocalPath") == 0)
+				m_localPath = value;
 			else if (::strcmp(key, "RuleTrace") == 0)
 				m_ruleTrace = ::atoi(value) == 1;
 			else if (::strcmp(key, "Debug") == 0)
@@ -473,6 +508,41 @@ bool CConf::getTrunkingEnabled() const
 	return m_trunkingEnabled;
 }
 
+bool CConf::getThreaded() const
+{
+	return m_threaded;
+}
+
+bool CConf::getConnectedSockets() const
+{
+	return m_connectedSockets;
+}
+
+bool CConf::getPacing() const
+{
+	return m_pacing;
+}
+
+std::string CConf::getRxOverflow() const
+{
+	return m_rxOverflow;
+}
+
+bool CConf::getRealtime() const
+{
+	return m_realtime;
+}
+
+unsigned int CConf::getRealtimePriority() const
+{
+	return m_realtimePriority;
+}
+
+std::vector<unsigned int> CConf::getRealtimeCPUs() const
+{
+	return m_realtimeCPUs;
+}
+
 std::string CConf::getRptAddress() const
 {
 	return m_rptAddress;
@@ -493,6 +563,21 @@ unsigned short CConf::getLocalPort() const
 	return m_localPort;
 }
 
+std::string CConf::getTransport() const
+{
+	return m_transport;
+}
+
+std::string CConf::getRptPath() const
+{
+	return m_rptPath;
+}
+
+std::string CConf::getLocalPath() const
+{
+	return m_localPath;
+}
+
 unsigned int CConf::getRFTimeout() const
 {
 	return m_rfTimeout;
@@ -102,12 +102,22 @@ public:
 	unsigned int getId() const;
 	bool         getDaemon() const;
 	bool         getTrunkingEnabled() const;
+	bool         getThreaded() const;
+	bool         getConnectedSockets() const;
+	bool         getPacing() const;
+	std::string  getRxOverflow() const;
+	bool         getRealtime() const;
+	unsigned int getRealtimePriority() const;
+	std::vector<unsigned int> getRealtimeCPUs() const;
 	unsigned int getRFTimeout() const;
 	unsigned int getNetTimeout() const;
 	std::string  getRptAddress() const;
 	unsigned short getRptPort() const;
 	std::string  getLocalAddress() const;
 	unsigned short getLocalPort() const;
+	std::string  getTransport() const;
+	std::string  getRptPath() const;
+	std::string  getLocalPath() const;
 	bool         getRuleTrace() const;
 	bool         getDebug() const;
 
@@ -205,10 +215,20 @@ private:
 	unsigned int m_id;
 	bool         m_daemon;
 	bool         m_trunkingEnabled;
+	bool         m_threaded;
+	bool         m_connectedSockets;
+	bool         m_pacing;
+	std::string  m_rxOverflow;
+	bool         m_realtime;
+	unsigned int m_realtimePriority;
+	std::vector<unsigned int> m_realtimeCPUs;
 	std::string  m_rptAddress;
 	unsigned short m_rptPort;
 	std::string  m_localAddress;
 	unsigned short m_localPort;
+	std::string  m_transport;
+	std::string  m_rptPath;
+	std::string  m_localPath;
 	unsigned int m_rfTimeout;
 	unsigned int m_netTimeout;
 	bool         m_ruleTrace;
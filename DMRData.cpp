@@ -22,179 +22,130 @@
 #include <cassert>
 
 
-CDMRData::CDMRData(const CDMRData& data) :
-m_slotNo(data.m_slotNo),
-m_data(nullptr),
-m_srcId(data.m_srcId),
-m_dstId(data.m_dstId),
-m_flco(data.m_flco),
-m_dataType(data.m_dataType),
-m_seqNo(data.m_seqNo),
-m_n(data.m_n),
-m_ber(data.m_ber),
-m_rssi(data.m_rssi),
-m_streamId(data.m_streamId),
-m_messageSize(data.m_messageSize),
-m_messageFlag(data.m_messageFlag)
-{
-	m_data = new unsigned char[2U * DMR_FRAME_LENGTH_BYTES];
-	::memcpy(m_data, data.m_data, 2U * DMR_FRAME_LENGTH_BYTES);
-	m_uuid = new unsigned char[16U];
-	::memcpy(m_uuid, data.m_uuid, 16U);
-	m_message = new unsigned char[255U];
-	::memcpy(m_message, data.m_message, 255U);
+CDMRData::CDMRData(const CDMRData& data)
+{
+	copy(data);
 }
 
+// A voice frame with no sequence letter, on slot 1, to a talk group
 CDMRData::CDMRData() :
-m_slotNo(1U),
-m_data(nullptr),
-m_srcId(0U),
-m_dstId(0U),
-m_flco(FLCO::GROUP),
-m_dataType(0U),
-m_seqNo(0U),
-m_n(0U),
-m_ber(0U),
-m_rssi(0U),
-m_streamId(0U),
 m_messageSize(0U),
-m_messageFlag(false)
+m_messageFlag(false),
+m_timestamp(0ULL)
 {
-	m_data = new unsigned char[2U * DMR_FRAME_LENGTH_BYTES];
-	m_uuid = new unsigned char[16U];
-	::memset(m_uuid, 0, 16U);
-	m_message = new unsigned char[255U];
-	::memset(m_message, 0, 255U);
+	::memset(m_packet, 0x00U, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH);
+	::memcpy(m_packet, "DMRD", 4U);
 }
 
 CDMRData::~CDMRData()
 {
-	delete[] m_data;
-	delete[] m_message;
-	delete[] m_uuid;
 }
 
 CDMRData& CDMRData::operator=(const CDMRData& data)
 {
-	if (this != &data) {
-		::memcpy(m_data, data.m_data, DMR_FRAME_LENGTH_BYTES);
-		::memcpy(m_uuid, data.m_uuid, 16U);
-		::memcpy(m_message, data.m_message, 255U);
-
-		m_slotNo   = data.m_slotNo;
-		m_srcId    = data.m_srcId;
-		m_dstId    = data.m_dstId;
-		m_flco     = data.m_flco;
-		m_dataType = data.m_dataType;
-		m_seqNo    = data.m_seqNo;
-		m_n        = data.m_n;
-		m_ber      = data.m_ber;
-		m_rssi     = data.m_rssi;
-		m_streamId = data.m_streamId;
-		m_messageFlag = data.m_messageFlag;
-		m_messageSize = data.m_messageSize;
-	}
+	if (this != &data)
+		copy(data);
 
 	return *this;
 }
 
 unsigned int CDMRData::getSlotNo() const
 {
-	return m_slotNo;
+	return view().getSlotNo();
 }
 
 void CDMRData::setSlotNo(unsigned int slotNo)
 {
 	assert(slotNo == 1U || slotNo == 2U);
 
-	m_slotNo = slotNo;
+	view().setSlotNo(slotNo);
 }
 
 unsigned char CDMRData::getDataType() const
 {
-	return m_dataType;
+	return view().getDataType();
 }
 
 void CDMRData::setDataType(unsigned char dataType)
 {
-	m_dataType = dataType;
+	view().setDataType(dataType);
 }
 
 unsigned int CDMRData::getSrcId() const
 {
-	return m_srcId;
+	return view().getSrcId();
 }
 
 void CDMRData::setSrcId(unsigned int id)
 {
-	m_srcId = id;
+	view().setSrcId(id);
 }
 
 unsigned int CDMRData::getDstId() const
 {
-	return m_dstId;
+	return view().getDstId();
 }
 
 void CDMRData::setDstId(unsigned int id)
 {
-	m_dstId = id;
+	view().setDstId(id);
 }
 
 FLCO CDMRData::getFLCO() const
 {
-	return m_flco;
+	return view().getFLCO();
 }
 
 void CDMRData::setFLCO(FLCO flco)
 {
-	m_flco = flco;
+	view().setFLCO(flco);
 }
 
 unsigned char CDMRData::getSeqNo() const
 {
-	return m_seqNo;
+	return view().getSeqNo();
 }
 
 void CDMRData::setSeqNo(unsigned char seqNo)
 {
-	m_seqNo = seqNo;
+	view().setSeqNo(seqNo);
 }
 
 unsigned char CDMRData::getN() const
 {
-	return m_n;
+	return view().getN();
 }
 
 void CDMRData::setN(unsigned char n)
 {
-	m_n = n;
+	view().setN(n);
 }
 
 unsigned char CDMRData::getBER() const
 {
-	return m_ber;
+	return view().getBER();
 }
 
 void CDMRData::setBER(unsigned char ber)
 {
-	m_ber = ber;
+	view().setBER(ber);
 }
 
 unsigned char CDMRData::getRSSI() const
 {
-	return m_rssi;
+	return view().getRSSI();
 }
 
 void CDMRData::setRSSI(unsigned char rssi)
 {
-	m_rssi = rssi;
+	view().setRSSI(rssi);
 }
 
 unsigned int CDMRData::getData(unsigned char* buffer) const
 {
 	assert(buffer != nullptr);
 
-	::memcpy(buffer, m_data, DMR_FRAME_LENGTH_BYTES);
+	::memcpy(buffer, view().getPayload(), DMR_FRAME_LENGTH_BYTES);
 
 	return DMR_FRAME_LENGTH_BYTES;
 }
@@ -203,29 +154,29 @@ void CDMRData::setData(const unsigned char* buffer)
 {
 	assert(buffer != nullptr);
 
-	::memcpy(m_data, buffer, DMR_FRAME_LENGTH_BYTES);
+	::memcpy(view().getPayload(), buffer, DMR_FRAME_LENGTH_BYTES);
 }
 
 unsigned int CDMRData::getStreamId() const
 {
-	return m_streamId;
+	return view().getStreamId();
 }
 
 void CDMRData::setStreamId(unsigned int id)
 {
-	m_streamId = id;
+	view().setStreamId(id);
 }
 
 void CDMRData::setUUID(unsigned char *uuid)
 {
 	assert(uuid != nullptr);
-	::memcpy(m_uuid, uuid, 16U);
+	::memcpy(view().getUUID(), uuid, 16U);
 }
 
 void CDMRData::getUUID(unsigned char *uuid) const
 {
 	assert(uuid != nullptr);
-	::memcpy(uuid, m_uuid, 16U);
+	::memcpy(uuid, view().getUUID(), 16U);
 }
 
 void CDMRData::setMessageSize(unsigned int size)
@@ -241,9 +192,8 @@ unsigned int CDMRData::getMessageSize() const
 void CDMRData::setMessageFlag(bool is_message)
 {
 	m_messageFlag = is_message;
-	if(!is_message) {
-		::memset(m_message, 0, 255U);
-	}
+	if(!is_message)
+		m_messageSize = 0U;
 }
 
 bool CDMRData::getMessageFlag() const
@@ -271,3 +221,38 @@ unsigned int CDMRData::getMessage(unsigned char* buffer) const
 	}
 	return 0U;
 }
+
+// When the frame was received, in wall clock nanoseconds, or zero if it was made here
+void CDMRData::setTimestamp(unsigned long long timestamp)
+{
+	m_timestamp = timestamp;
+}
+
+unsigned long long CDMRData::getTimestamp() const
+{
+	return m_timestamp;
+}
+
+// The DMRD frame as it came off the wire, or as it has been built up here, always with room for the UUID
+unsigned char* CDMRData::getPacket()
+{
+	return m_packet;
+}
+
+const unsigned char* CDMRData::getPacket() const
+{
+	return m_packet;
+}
+
+// Only the part of the message buffer in use is copied, so a voice frame costs no more than its DMRD frame
+void CDMRData::copy(const CDMRData& data)
+{
+	::memcpy(m_packet, data.m_packet, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH);
+
+	m_messageFlag = data.m_messageFlag;
+	m_messageSize = data.m_messageFlag ? data.m_messageSize : 0U;
+	m_timestamp   = data.m_timestamp;
+
+	if (m_messageSize > 0U)
+		::memcpy(m_message, data.m_message, m_messageSize);
+}
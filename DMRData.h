@@ -15,6 +15,7 @@
 #define	DMRData_H
 
 #include "DMRDefines.h"
+#include "DMRPacket.h"
 
 class CDMRData {
 public:
@@ -69,22 +70,26 @@ public:
 	bool setMessage(const unsigned char* buffer, unsigned int size);
 	unsigned int getMessage(unsigned char* buffer) const;
 
+	unsigned char*       getPacket();
+	const unsigned char* getPacket() const;
+
+	void setTimestamp(unsigned long long timestamp);
+	unsigned long long getTimestamp() const;
+
 private:
-	unsigned int   m_slotNo;
-	unsigned char* m_data;
-	unsigned int   m_srcId;
-	unsigned int   m_dstId;
-	FLCO           m_flco;
-	unsigned char  m_dataType;
-	unsigned char  m_seqNo;
-	unsigned char  m_n;
-	unsigned char  m_ber;
-	unsigned char  m_rssi;
-	unsigned int   m_streamId;
-	unsigned char* m_uuid;
-	unsigned char* m_message;
+	unsigned char  m_packet[HOMEBREW_TRUNKING_DATA_PACKET_LENGTH];
+	unsigned char  m_message[255U];
 	unsigned int   m_messageSize;
 	bool           m_messageFlag;
+	unsigned long long m_timestamp;
+
+	void copy(const CDMRData& data);
+
+	// The getters only read through the view
+	CDMRPacket view() const
+	{
+		return CDMRPacket(const_cast<unsigned char*>(m_packet));
+	}
 };
 
 #endif
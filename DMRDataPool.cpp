@@ -0,0 +1,89 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DMRDataPool.h"
+#include "Log.h"
+
+#include <cassert>
+
+CDMRDataPool::CDMRDataPool(unsigned int frames) :
+m_blockSize(frames),
+m_blocks(),
+m_free()
+{
+	assert(frames > 0U);
+
+	grow();
+}
+
+CDMRDataPool::~CDMRDataPool()
+{
+	for (std::vector<CDMRData*>::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+		delete[] *it;
+}
+
+CDMRData* CDMRDataPool::get()
+{
+	if (m_free.empty()) {
+		grow();
+		LogMessage("Voice frame pool is now %u frames", getSize());
+	}
+
+	CDMRData* data = m_free.back();
+	m_free.pop_back();
+
+	*data = CDMRData();
+
+	return data;
+}
+
+void CDMRDataPool::put(CDMRData* data)
+{
+	assert(data != nullptr);
+
+	m_free.push_back(data);
+}
+
+void CDMRDataPool::put(std::vector<CDMRData*>& frames)
+{
+	m_free.insert(m_free.end(), frames.begin(), frames.end());
+
+	frames.clear();
+}
+
+unsigned int CDMRDataPool::getSize() const
+{
+	return (unsigned int)m_blocks.size() * m_blockSize;
+}
+
+unsigned int CDMRDataPool::getFree() const
+{
+	return (unsigned int)m_free.size();
+}
+
+void CDMRDataPool::grow()
+{
+	CDMRData* block = new CDMRData[m_blockSize];
+	m_blocks.push_back(block);
+
+	// Room for every frame there is, so that handing them back never needs to allocate
+	m_free.reserve(getSize());
+
+	for (unsigned int i = 0U; i < m_blockSize; i++)
+		m_free.push_back(block + m_blockSize - 1U - i);
+}
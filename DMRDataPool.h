@@ -0,0 +1,54 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DMRDataPool_H)
+#define	DMRDataPool_H
+
+#include "DMRData.h"
+
+#include <vector>
+
+// A store of frames for the voice announcements, shared between all of the announcers. The frames
+// are allocated up front in blocks and handed back when an announcement ends or is aborted, so
+// building the next one doesn't touch the heap. A further block is only allocated if more frames
+// are wanted at once than have ever been wanted before. Must only be used from one thread.
+class CDMRDataPool {
+public:
+	CDMRDataPool(unsigned int frames);
+	~CDMRDataPool();
+
+	// A frame set as a newly constructed one would be
+	CDMRData* get();
+
+	void put(CDMRData* data);
+
+	// Returns all of the frames in the list and empties it
+	void put(std::vector<CDMRData*>& frames);
+
+	unsigned int getSize() const;
+	unsigned int getFree() const;
+
+private:
+	unsigned int             m_blockSize;
+	std::vector<CDMRData*>   m_blocks;
+	std::vector<CDMRData*>   m_free;
+
+	void grow();
+};
+
+#endif
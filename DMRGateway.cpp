@@ -30,7 +30,6 @@
 #include "PassAllTG.h"
 #include "DMRFullLC.h"
 #include "Version.h"
-#include "Thread.h"
 #include "DMRLC.h"
 #include "Utils.h"
 #include "Sync.h"
@@ -59,6 +58,22 @@ const unsigned int XLX_TG   = 9U;
 
 const unsigned char COLOR_CODE = 3U;
 
+// The longest the main loop will sleep when nothing arrives and no timer
+// is due, and the shorter one used while voice announcements are being
+// paced out
+const unsigned int IDLE_TIMEOUT  = 1000U;
+const unsigned int VOICE_TIMEOUT = 10U;
+
+// How often, in seconds, the network receive statistics are published
+const unsigned int STATS_INTERVAL = 60U;
+
+// Dynamic TG and remote control messages waiting for the main loop, enough for a script that
+// sends a burst of commands while the main loop is busy
+const unsigned int MQTT_QUEUE_LENGTH = 256U;
+
+// Enough voice frames for a few announcements at once, more are allocated if ever needed
+const unsigned int VOICE_POOL_FRAMES = 256U;
+
 static bool m_killed = false;
 static int  m_signal = 0;
 
@@ -169,10 +184,13 @@ m_xlxModule(),
 m_rptRewrite(nullptr),
 m_xlxRewrite(nullptr),
 m_xlxVoice(nullptr),
+m_voicePool(nullptr),
 m_dmrNetRewrites(),
 m_dmrRFRewrites(),
 m_dmrSrcRewrites(),
 m_dmrPassalls(),
+m_rfIndex(),
+m_netIndexes(),
 m_dynVoices(),
 m_dynRF(),
 m_writer(nullptr),
@@ -185,7 +203,15 @@ m_gpsd(nullptr),
 m_networkEnabled(nullptr),
 m_networkXlxEnabled(false),
 m_trunkingEnabled(false),
-m_remoteControl(nullptr)
+m_remoteControl(nullptr),
+m_threaded(false),
+m_rxOverflow(RING_OVERFLOW::BLOCK),
+m_poller(),
+m_mqttQueue(MQTT_QUEUE_LENGTH, "MQTT"),
+m_resolver(),
+m_realtime(),
+m_loopJitter(),
+m_statsTimer(1000U, STATS_INTERVAL)
 {
 	CUDPSocket::startup();
 
@@ -215,6 +241,8 @@ CDMRGateway::~CDMRGateway()
 	for (std::vector<CDynVoice*>::iterator it = m_dynVoices.begin(); it != m_dynVoices.end(); ++it)
 		delete* it;
 
+	delete m_voicePool;
+
 	delete m_rptRewrite;
 	delete m_xlxRewrite;
 
@@ -297,6 +325,11 @@ int CDMRGateway::run()
 
 	::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel());
 
+	// Opened before MQTT, whose thread wakes the main loop for each message it passes on
+	bool polling = m_poller.open();
+	if (!polling)
+		LogWarning("Unable to create the socket poller, falling back to a fixed sleep");
+
 	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> subscriptions;
 	if (m_conf.getDynamicTGControlEnabled())
 		subscriptions.push_back(std::make_pair("dynamic", CDMRGateway::onDynamic));
@@ -330,6 +363,7 @@ int CDMRGateway::run()
 	m_dmrRFRewrites.resize(m_dmrNetworkCount);
 	m_dmrSrcRewrites.resize(m_dmrNetworkCount);
 	m_dmrPassalls.resize(m_dmrNetworkCount);
+	m_netIndexes.resize(m_dmrNetworkCount);
 
 	LogInfo(HEADER1);
 	LogInfo(HEADER2);
@@ -341,6 +375,44 @@ int CDMRGateway::run()
 
 	WriteJSONStatus("DMRGateway is starting");
 
+	// The network threads need to be able to wake the main loop
+	m_threaded = polling && m_conf.getThreaded();
+#if defined(_WIN32) || defined(_WIN64)
+	if (m_threaded) {
+		LogWarning("Threaded network I/O is not supported on Windows, ignoring");
+		m_threaded = false;
+	}
+#endif
+	if (m_threaded)
+		LogInfo("Running the MMDVM and DMR networks on their own threads");
+
+	if (m_conf.getConnectedSockets())
+		LogInfo("Connecting the network sockets to their remote addresses");
+
+	if (m_conf.getPacing())
+		LogInfo("Pacing the network frames to the repeater at the DMR slot rate");
+
+	std::string rxOverflow = m_conf.getRxOverflow();
+	if (rxOverflow == "drop-oldest") {
+		m_rxOverflow = RING_OVERFLOW::DROP_OLDEST;
+	} else if (rxOverflow == "drop-newest") {
+		m_rxOverflow = RING_OVERFLOW::DROP_NEWEST;
+	} else if (rxOverflow != "block") {
+		LogWarning("Unknown RxOverflow value of %s, using block", rxOverflow.c_str());
+		rxOverflow = "block";
+	}
+	LogInfo("Network receive queue overflow: %s", rxOverflow.c_str());
+
+	// Without it the master addresses are looked up as each network is opened
+	m_resolver.start();
+
+	// The network threads inherit the priority and CPUs, the MQTT and DNS threads already exist so don't,
+	// and the XLX reflector loading thread goes back to normal scheduling when it starts
+	if (m_conf.getRealtime()) {
+		m_realtime.open(m_conf.getRealtimePriority(), m_conf.getRealtimeCPUs());
+		m_realtime.measure();
+	}
+
 	ret = createMMDVM();
 	if (!ret)
 		return 1;
@@ -383,8 +455,10 @@ int CDMRGateway::run()
 		LogInfo("    Language: %s", language.c_str());
 		LogInfo("    Directory: %s", directory.c_str());
 
+		m_voicePool = new CDMRDataPool(VOICE_POOL_FRAMES);
+
 		if (m_xlxNetwork != nullptr) {
-			m_xlxVoice = new CXLXVoice(directory, language, m_id, m_xlxSlot, m_xlxTG);
+			m_xlxVoice = new CXLXVoice(directory, language, m_id, m_xlxSlot, m_xlxTG, m_voicePool);
 			bool ret = m_xlxVoice->open();
 			if (!ret) {
 				delete m_xlxVoice;
@@ -405,6 +479,8 @@ int CDMRGateway::run()
 		}
 	}
 
+	compileRewrites();
+
 	createAPRS();
 
 	unsigned int rfTimeout  = m_conf.getRFTimeout();
@@ -421,6 +497,9 @@ int CDMRGateway::run()
 	std::vector<std::vector<unsigned int>> dmrSrcId(m_dmrNetworkCount, std::vector<unsigned int>(3U, 0U));
 	std::vector<std::vector<unsigned int>> dmrDstId(m_dmrNetworkCount, std::vector<unsigned int>(3U, 0U));
 
+	m_statsTimer.setCallback(CDMRGateway::onStats, this);
+	m_statsTimer.start();
+
 	CStopWatch stopWatch;
 	stopWatch.start();
 
@@ -428,6 +507,71 @@ int CDMRGateway::run()
 	LogInfo("Built %s %s (GitID #%.7s)", __TIME__, __DATE__, gitversion);
 
 	while (!m_killed) {
+		// Sleep until a packet arrives on one of the sockets, or something needs servicing. How late
+		// a timed out wait returns is the scheduling jitter of the loop.
+		unsigned int timeout = getPollTimeout();
+		unsigned long long deadline = CLatencyHistogram::now() + timeout * 1000000ULL;
+
+		int events = m_poller.wait(timeout);
+		if ((events == 0) && (timeout > 0U))
+			m_loopJitter.add(deadline);
+
+		CTimerService::clock();
+
+		if (!m_mqttQueue.isEmpty())
+			processMQTTMessages();
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		// The network threads clock their own networks
+		if (!m_threaded)
+			m_repeater->clock(ms);
+
+		m_xlxRelink.clock(ms);
+
+		for (unsigned int i = 0; i < m_dmrNetworkCount; i++) {
+			if (m_dmrNetworks[i] != nullptr) {
+				if (!m_threaded)
+					m_dmrNetworks[i]->clock(ms);
+
+				bool connected = m_dmrNetworks[i]->isConnected();
+				if (connected != m_dmrNetworkStatus[i]) {
+					m_dmrNetworkStatus[i] = connected;
+					writeJSONLink(m_dmrName[i], connected);
+				}
+			}
+		}
+
+		if (m_xlxNetwork != nullptr)
+			m_xlxNetwork->clock(ms);
+
+		if (m_xlxReflectors != nullptr)
+			m_xlxReflectors->clock(ms);
+
+		if (m_xlxVoice != nullptr)
+			m_xlxVoice->clock(ms);
+
+#if defined(USE_GPSD)
+		if (m_gpsd != nullptr)
+			m_gpsd->clock(ms);
+#endif
+
+		if (m_writer != nullptr)
+			m_writer->clock(ms);
+
+		for (std::vector<CDynVoice*>::iterator it = m_dynVoices.begin(); it != m_dynVoices.end(); ++it)
+			(*it)->clock(ms);
+
+		// Check timer for both slots & free if expired
+		for (unsigned int i = 1U; i < 3U; i++) {
+			timer[i]->clock(ms);
+			if (timer[i]->isRunning() && timer[i]->hasExpired()) {
+				m_extStatus[i].m_status = DMRGW_STATUS::NONE;
+				timer[i]->stop();
+			}
+		}
+
 		if (m_networkXlxEnabled && (m_xlxNetwork != nullptr)) {
 			bool connected = m_xlxNetwork->isConnected();
 			if (connected && !m_xlxConnected) {
@@ -602,67 +746,33 @@ int CDMRGateway::run()
 
 				PROCESS_RESULT result = PROCESS_RESULT::UNMATCHED;
 
-				// Match by m_dmrRFRewrites
-				for (unsigned int i = 0; i < m_dmrNetworkCount; i++) {
-					if (result != PROCESS_RESULT::UNMATCHED)
-						break;
-
-					if (m_networkEnabled[i] && (m_dmrNetworks[i] != nullptr)) {
-						// Rewrite the slot and/or TG or neither
-						for (CRewrite* rewrite: m_dmrRFRewrites[i]) {
-							PROCESS_RESULT res = rewrite->process(data, trace);
-							if (res != PROCESS_RESULT::UNMATCHED) {
-								result = res;
-								break;
-							}
-						}
-
-						if (result == PROCESS_RESULT::MATCHED) {
-							slotNo = data.getSlotNo();
-							if (m_trunkingEnabled || (m_extStatus[slotNo].m_status == DMRGW_STATUS::NONE) || (
-									m_extStatus[slotNo].m_status == DMRGW_STATUS::DMRNETWORK &&
-									m_extStatus[slotNo].m_dmrNetwork == i)
-							) {
-								rewrite(m_dmrSrcRewrites[i], data, trace);
-								m_dmrNetworks[i]->write(data);
-								m_extStatus[slotNo].m_status = DMRGW_STATUS::DMRNETWORK;
-								m_extStatus[slotNo].m_dmrNetwork = i;
-								timer[slotNo]->setTimeout(rfTimeout);
-								timer[slotNo]->start();
-							}
-						}
-					}
-				}
+				// Match by m_dmrRFRewrites and then by m_dmrPassalls, network by network
+				const std::vector<CRewriteRoute>& routes = m_rfIndex.find(slotNo, flco, dstId, trace);
+				for (const CRewriteRoute& route : routes) {
+					unsigned int i = route.m_network;
+					if (!m_networkEnabled[i] || (m_dmrNetworks[i] == nullptr))
+						continue;
 
-				// Match by m_dmrPassalls
-				for (unsigned int i = 0; i < m_dmrNetworkCount; i++) {
-					if (result != PROCESS_RESULT::UNMATCHED)
-						break;
-
-					if (m_networkEnabled[i] && (m_dmrNetworks[i] != nullptr)) {
-						for (CRewrite* rewrite: m_dmrPassalls[i]) {
-							PROCESS_RESULT res = rewrite->process(data, trace);
-							if (res != PROCESS_RESULT::UNMATCHED) {
-								result = res;
-								break;
-							}
-						}
+					result = route.m_rewrite->process(data, trace);
+					if (result == PROCESS_RESULT::UNMATCHED)
+						continue;
 
-						if (result == PROCESS_RESULT::MATCHED) {
-							slotNo = data.getSlotNo();
-							if (m_trunkingEnabled || (m_extStatus[slotNo].m_status == DMRGW_STATUS::NONE) || (
-									m_extStatus[slotNo].m_status == DMRGW_STATUS::DMRNETWORK &&
-									m_extStatus[slotNo].m_dmrNetwork == i)
-							) {
-								rewrite(m_dmrSrcRewrites[i], data, trace);
-								m_dmrNetworks[i]->write(data);
-								m_extStatus[slotNo].m_status = DMRGW_STATUS::DMRNETWORK;
-								m_extStatus[slotNo].m_dmrNetwork = i;
-								timer[slotNo]->setTimeout(rfTimeout);
-								timer[slotNo]->start();
-							}
+					if (result == PROCESS_RESULT::MATCHED) {
+						slotNo = data.getSlotNo();
+						if (m_trunkingEnabled || (m_extStatus[slotNo].m_status == DMRGW_STATUS::NONE) || (
+								m_extStatus[slotNo].m_status == DMRGW_STATUS::DMRNETWORK &&
+								m_extStatus[slotNo].m_dmrNetwork == i)
+						) {
+							rewrite(m_dmrSrcRewrites[i], data, trace);
+							m_dmrNetworks[i]->write(data);
+							m_extStatus[slotNo].m_status = DMRGW_STATUS::DMRNETWORK;
+							m_extStatus[slotNo].m_dmrNetwork = i;
+							timer[slotNo]->setTimeout(rfTimeout);
+							timer[slotNo]->start();
 						}
 					}
+
+					break;
 				}
 
 				if (result == PROCESS_RESULT::UNMATCHED && trace)
@@ -719,8 +829,9 @@ int CDMRGateway::run()
 
 					// Rewrite the slot and/or TG or neither
 					bool rewritten = false;
-					for (CRewrite* rewrite: m_dmrNetRewrites[i]) {
-						PROCESS_RESULT ret = rewrite->process(data, trace);
+					const std::vector<CRewriteRoute>& routes = m_netIndexes[i].find(slotNo, flco, dstId, trace);
+					for (const CRewriteRoute& route : routes) {
+						PROCESS_RESULT ret = route.m_rewrite->process(data, trace);
 						if (ret == PROCESS_RESULT::MATCHED) {
 							rewritten = true;
 							break;
@@ -774,57 +885,19 @@ int CDMRGateway::run()
 				m_repeater->write(data);
 		}
 
-		unsigned int ms = stopWatch.elapsed();
-		stopWatch.start();
-
-		m_repeater->clock(ms);
-
-		m_xlxRelink.clock(ms);
-
-		for (unsigned int i = 0; i < m_dmrNetworkCount; i++) {
-			if (m_dmrNetworks[i] != nullptr) {
-				m_dmrNetworks[i]->clock(ms);
+		// Send everything queued during this pass, one system call per socket, the
+		// network threads do their own
+		if (!m_threaded) {
+			m_repeater->flush();
 
-				bool connected = m_dmrNetworks[i]->isConnected();
-				if (connected != m_dmrNetworkStatus[i]) {
-					m_dmrNetworkStatus[i] = connected;
-					writeJSONLink(m_dmrName[i], connected);
-				}
+			for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+				if (m_dmrNetworks[i] != nullptr)
+					m_dmrNetworks[i]->flush();
 			}
 		}
 
 		if (m_xlxNetwork != nullptr)
-			m_xlxNetwork->clock(ms);
-
-		if (m_xlxReflectors != nullptr)
-			m_xlxReflectors->clock(ms);
-
-		if (m_xlxVoice != nullptr)
-			m_xlxVoice->clock(ms);
-
-#if defined(USE_GPSD)
-		if (m_gpsd != nullptr)
-			m_gpsd->clock(ms);
-#endif
-
-		if (m_writer != nullptr)
-			m_writer->clock(ms);
-
-		for (std::vector<CDynVoice*>::iterator it = m_dynVoices.begin(); it != m_dynVoices.end(); ++it)
-			(*it)->clock(ms);
-
-		// Check timer for both slots & free if expired
-		for (unsigned int i = 1U; i < 3U; i++) {
-			timer[i]->clock(ms);
-			if (timer[i]->isRunning() && timer[i]->hasExpired()) {
-				m_extStatus[i].m_status = DMRGW_STATUS::NONE;
-				timer[i]->stop();
-			}
-		}
-
-		unsigned int sleep_time = m_trunkingEnabled ? 2U : 10U;
-		if (ms < sleep_time)
-			CThread::sleep(sleep_time);
+			m_xlxNetwork->flush();
 	}
 
 	LogInfo("DMRGateway is stopping");
@@ -861,6 +934,8 @@ int CDMRGateway::run()
 		delete m_xlxNetwork;
 	}
 
+	m_resolver.stop();
+
 	delete timer[1U];
 	delete timer[2U];
 
@@ -878,12 +953,31 @@ bool CDMRGateway::createMMDVM()
 	bool debug               = m_conf.getDebug();
 
 	LogInfo("MMDVM Network Parameters");
-	LogInfo("    Rpt Address: %s", rptAddress.c_str());
-	LogInfo("    Rpt Port: %hu", rptPort);
-	LogInfo("    Local Address: %s", localAddress.c_str());
-	LogInfo("    Local Port: %hu", localPort);
+
+	if (m_conf.getTransport() == "unix") {
+		// Without a port the addresses are the paths of Unix domain sockets
+		rptAddress   = m_conf.getRptPath();
+		rptPort      = 0U;
+		localAddress = m_conf.getLocalPath();
+		localPort    = 0U;
+
+		LogInfo("    Rpt Path: %s", rptAddress.c_str());
+		LogInfo("    Local Path: %s", localAddress.c_str());
+	} else {
+		LogInfo("    Rpt Address: %s", rptAddress.c_str());
+		LogInfo("    Rpt Port: %hu", rptPort);
+		LogInfo("    Local Address: %s", localAddress.c_str());
+		LogInfo("    Local Port: %hu", localPort);
+	}
 
 	m_repeater = new CMMDVMNetwork(rptAddress, rptPort, localAddress, localPort, m_id, debug, m_trunkingEnabled);
+	m_repeater->setConnectedSocket(m_conf.getConnectedSockets());
+	m_repeater->setPacing(m_conf.getPacing());
+	m_repeater->setRxOverflow(m_rxOverflow);
+	if (m_threaded)
+		m_repeater->setThreaded(&m_poller);
+	else
+		m_repeater->setPoller(&m_poller);
 
 	bool ret = m_repeater->open();
 	if (!ret) {
@@ -921,6 +1015,13 @@ bool CDMRGateway::createDMRNetwork(unsigned int index)
 	LogInfo("    Location Data: %s", location ? "yes" : "no");
 
 	m_dmrNetworks[index] = new CDMRNetwork(address, port, local, id, password, m_dmrName[index], location, debug, m_trunkingEnabled);
+	m_dmrNetworks[index]->setConnectedSocket(m_conf.getConnectedSockets());
+	m_dmrNetworks[index]->setResolver(&m_resolver);
+	m_dmrNetworks[index]->setRxOverflow(m_rxOverflow);
+	if (m_threaded)
+		m_dmrNetworks[index]->setThreaded(&m_poller);
+	else
+		m_dmrNetworks[index]->setPoller(&m_poller);
 
 	std::string options = m_conf.getDMRNetworkOptions(index);
 
@@ -1008,7 +1109,7 @@ bool CDMRGateway::createDMRNetwork(unsigned int index)
 			std::string language  = m_conf.getVoiceLanguage();
 			std::string directory = m_conf.getVoiceDirectory();
 
-			voice = new CDynVoice(directory, language, m_id, (*it).m_slot, (*it).m_toTG);
+			voice = new CDynVoice(directory, language, m_id, (*it).m_slot, (*it).m_toTG, m_voicePool);
 			bool ret = voice->open();
 			if (!ret) {
 				delete voice;
@@ -1064,6 +1165,37 @@ bool CDMRGateway::createDMRNetwork(unsigned int index)
 	return true;
 }
 
+void CDMRGateway::compileRewrites()
+{
+	// Every network's RF rewrites come before any of the pass alls, just as they're tried
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		for (CRewrite* rewrite : m_dmrRFRewrites[i])
+			m_rfIndex.add(rewrite, i);
+	}
+
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		for (CRewrite* rewrite : m_dmrPassalls[i])
+			m_rfIndex.add(rewrite, i);
+	}
+
+	m_rfIndex.compile();
+
+	unsigned int rules    = m_rfIndex.getRules();
+	unsigned int segments = m_rfIndex.getSegments();
+
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		for (CRewrite* rewrite : m_dmrNetRewrites[i])
+			m_netIndexes[i].add(rewrite, i);
+
+		m_netIndexes[i].compile();
+
+		rules    += m_netIndexes[i].getRules();
+		segments += m_netIndexes[i].getSegments();
+	}
+
+	LogInfo("Compiled %u rewrite rules into %u segments", rules, segments);
+}
+
 bool CDMRGateway::createXLXNetwork()
 {
 	std::string fileName    = m_conf.getXLXNetworkFile();
@@ -1154,6 +1286,10 @@ bool CDMRGateway::linkXLX(const std::string &number)
 	m_xlxRelink.stop();
 
 	m_xlxNetwork = new CDMRNetwork(reflector->m_address, m_xlxPort, m_xlxLocal, m_xlxId, m_xlxPassword, "XLX", false, m_xlxDebug, m_trunkingEnabled);
+	m_xlxNetwork->setConnectedSocket(m_conf.getConnectedSockets());
+	m_xlxNetwork->setResolver(&m_resolver);
+	m_xlxNetwork->setRxOverflow(m_rxOverflow);
+	m_xlxNetwork->setPoller(&m_poller);
 
 	unsigned char config[400U];
 	unsigned int len = getConfig("XLX", config);
@@ -1325,6 +1461,32 @@ unsigned int CDMRGateway::getConfig(const std::string& name, unsigned char* buff
 	return (unsigned int)::strlen((char*)buffer);
 }
 
+unsigned int CDMRGateway::getPollTimeout() const
+{
+	// A single wakeup may have queued several packets, only one of which is routed per pass
+	if (m_repeater->hasData())
+		return 0U;
+
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		if (m_networkEnabled[i] && (m_dmrNetworks[i] != nullptr) && m_dmrNetworks[i]->hasData())
+			return 0U;
+	}
+
+	if (m_networkXlxEnabled && (m_xlxNetwork != nullptr) && m_xlxNetwork->hasData())
+		return 0U;
+
+	// The voice announcements are paced by the main loop, so keep it ticking over while they're active
+	if ((m_xlxVoice != nullptr) && m_xlxVoice->isBusy())
+		return CTimerService::getNextExpiry(VOICE_TIMEOUT);
+
+	for (std::vector<CDynVoice*>::const_iterator it = m_dynVoices.begin(); it != m_dynVoices.end(); ++it) {
+		if ((*it)->isBusy())
+			return CTimerService::getNextExpiry(VOICE_TIMEOUT);
+	}
+
+	return CTimerService::getNextExpiry(IDLE_TIMEOUT);
+}
+
 void CDMRGateway::processRadioPosition()
 {
 	unsigned char buffer[50U];
@@ -1555,6 +1717,50 @@ void CDMRGateway::writeJSONLink(const std::string& name, bool connected)
 	WriteJSON("link", json, true);
 }
 
+void CDMRGateway::writeJSONStats()
+{
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+
+	nlohmann::json networks = nlohmann::json::array();
+
+	nlohmann::json repeater;
+	m_repeater->writeStats(repeater);
+	networks.push_back(repeater);
+
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		if (m_dmrNetworks[i] != nullptr) {
+			nlohmann::json network;
+			m_dmrNetworks[i]->writeStats(network);
+			networks.push_back(network);
+		}
+	}
+
+	if (m_xlxNetwork != nullptr) {
+		nlohmann::json network;
+		m_xlxNetwork->writeStats(network);
+		networks.push_back(network);
+	}
+
+	json["networks"] = networks;
+
+	m_realtime.writeJSON(json["realtime"]);
+	m_loopJitter.writeJSON(json["loop_jitter"]);
+
+	WriteJSON("stats", json, false);
+}
+
+void CDMRGateway::onStats(void* param)
+{
+	assert(param != nullptr);
+
+	CDMRGateway* gateway = static_cast<CDMRGateway*>(param);
+
+	gateway->writeJSONStats();
+	gateway->m_statsTimer.start();
+}
+
 void CDMRGateway::buildNetworkHostsString(std::string &str)
 {
 	str = "";
@@ -1577,16 +1783,72 @@ void CDMRGateway::buildNetworkHostNetworkString(std::string &str, const std::str
 	}
 }
 
+// Frames to the repeater came from the networks, and those to the networks came from the repeater
+void CDMRGateway::buildNetworkLatencyString(std::string &str)
+{
+	nlohmann::json json;
+
+	m_repeater->writeLatency(json["net_rf"]);
+
+	nlohmann::json networks = nlohmann::json::object();
+	for (unsigned int i = 0U; i < m_dmrNetworkCount; i++) {
+		if (m_dmrNetworks[i] != nullptr)
+			m_dmrNetworks[i]->writeLatency(networks[m_dmrNetworks[i]->getName()]);
+	}
+
+	json["rf_net"] = networks;
+
+	if (m_xlxNetwork != nullptr)
+		m_xlxNetwork->writeLatency(json["xlx"]);
+
+	str = json.dump();
+}
+
+// These run on the MQTT thread, so the messages are passed to the main loop to be acted on
 void CDMRGateway::onDynamic(const unsigned char* message, unsigned int length)
 {
 	assert(gateway != nullptr);
 
-	gateway->processDynamicTGControl(std::string((char*)message, length));
+	gateway->queueMQTTMessage(true, message, length);
 }
 
 void CDMRGateway::onCommand(const unsigned char* message, unsigned int length)
 {
 	assert(gateway != nullptr);
 
-	gateway->remoteControl(std::string((char*)message, length));
+	gateway->queueMQTTMessage(false, message, length);
+}
+
+void CDMRGateway::queueMQTTMessage(bool dynamic, const unsigned char* message, unsigned int length)
+{
+	assert(message != nullptr);
+
+	CMQTTMessage item;
+	item.m_dynamic = dynamic;
+	item.m_text    = std::string((char*)message, length);
+
+	if (!m_mqttQueue.push(item)) {
+		if (dynamic) {
+			LogWarning("MQTT message queue is full, dropping a dynamic TG control message");
+		} else {
+			// The sender is waiting for an answer, so tell it the command was not run
+			LogWarning("MQTT message queue is full, refusing a remote command");
+			if (m_mqtt != nullptr)
+				m_mqtt->publish("response", "KO");
+		}
+		return;
+	}
+
+	m_poller.wake();
+}
+
+void CDMRGateway::processMQTTMessages()
+{
+	CMQTTMessage item;
+	while (m_mqttQueue.pop(item)) {
+		if (item.m_dynamic)
+			processDynamicTGControl(item.m_text);
+		else
+			remoteControl(item.m_text);
+	}
 }
@@ -26,8 +26,13 @@
 #include "DMRNetwork.h"
 #include "APRSWriter.h"
 #include "Reflectors.h"
+#include "Resolver.h"
+#include "Realtime.h"
+#include "Poller.h"
+#include "SPSCRing.h"
 #include "XLXVoice.h"
 #include "UDPSocket.h"
+#include "RewriteIndex.h"
 #include "RewriteTG.h"
 #include "DynVoice.h"
 #include "Rewrite.h"
@@ -43,6 +48,12 @@ enum class DMRGW_STATUS {
 	XLXREFLECTOR
 };
 
+// A message from one of the MQTT subscriptions, on its way from the MQTT thread to the main loop
+struct CMQTTMessage {
+	bool        m_dynamic;
+	std::string m_text;
+};
+
 struct CDMRGWExtStatus {
 	DMRGW_STATUS m_status;
 	unsigned int m_dmrNetwork;
@@ -58,6 +69,7 @@ public:
 
 	void buildNetworkStatusString(std::string &str);
 	void buildNetworkHostsString(std::string &str);
+	void buildNetworkLatencyString(std::string &str);
 
 private:
 	CConf              m_conf;
@@ -89,10 +101,13 @@ private:
 	CRewriteTG*        m_rptRewrite;
 	CRewriteTG*        m_xlxRewrite;
 	CXLXVoice*         m_xlxVoice;
+	CDMRDataPool*      m_voicePool;
 	std::vector<std::vector<CRewrite*>> m_dmrNetRewrites;
 	std::vector<std::vector<CRewrite*>> m_dmrRFRewrites;
 	std::vector<std::vector<CRewrite*>> m_dmrSrcRewrites;
 	std::vector<std::vector<CRewrite*>> m_dmrPassalls;
+	CRewriteIndex      m_rfIndex;
+	std::vector<CRewriteIndex> m_netIndexes;
 	std::vector<CDynVoice*> m_dynVoices;
 	std::vector<CRewriteDynTGRF*> m_dynRF;
 	CAPRSWriter*           m_writer;
@@ -106,9 +121,18 @@ private:
 	bool                   m_networkXlxEnabled;
 	bool                   m_trunkingEnabled;
 	CRemoteControl*        m_remoteControl;
+	bool                   m_threaded;
+	RING_OVERFLOW          m_rxOverflow;
+	CPoller                m_poller;
+	CSPSCRing<CMQTTMessage> m_mqttQueue;
+	CResolver              m_resolver;
+	CRealtime              m_realtime;
+	CLatencyHistogram      m_loopJitter;
+	CTimer                 m_statsTimer;
 
 	bool createMMDVM();
 	bool createDMRNetwork(unsigned int index);
+	void compileRewrites();
 	bool createXLXNetwork();
 
 	bool linkXLX(const std::string &number);
@@ -119,18 +143,24 @@ private:
 
 	unsigned int getConfig(const std::string& name, unsigned char* buffer);
 
+	unsigned int getPollTimeout() const;
+
 	void processRadioPosition();
 	void processTalkerAlias();
 	void createAPRS();
 	void processDynamicTGControl(const std::string& command);
 	void remoteControl(const std::string& command);
+	void queueMQTTMessage(bool dynamic, const unsigned char* message, unsigned int length);
+	void processMQTTMessages();
 	void processEnableCommand(CDMRNetwork* network, const std::string& name, bool& mode, bool enabled);
 	void buildNetworkStatusNetworkString(std::string &str, const std::string& name, CDMRNetwork* network, bool enabled);
 	void buildNetworkHostNetworkString(std::string &str, const std::string& name, CDMRNetwork* network);
 	void writeJSONLink(const std::string& name, bool connected);
+	void writeJSONStats();
 
 	static void onCommand(const unsigned char* message, unsigned int length);
 	static void onDynamic(const unsigned char* message, unsigned int length);
+	static void onStats(void* param);
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 #include "DMRNetwork.h"
 
+#include "HomebrewPacket.h"
 #include "StopWatch.h"
 #include "SHA256.h"
 #include "Utils.h"
@@ -28,9 +29,13 @@
 #include <cassert>
 
 const unsigned int BUFFER_LENGTH = 500U;
+const unsigned int BATCH_LENGTH  = 16U;
 
-const unsigned int HOMEBREW_DATA_PACKET_LENGTH = 55U;
-const unsigned int HOMEBREW_TRUNKING_DATA_PACKET_LENGTH = 71U; // DMRD with 16 byte UUID extension
+const unsigned int QUEUE_LENGTH  = 64U;
+const unsigned int IDLE_TIMEOUT  = 1000U;
+
+// Enough for a full batch from the socket
+const unsigned int RX_SLOTS = 16U;
 
 // Structured companion to the existing free-text WriteJSONStatus() calls
 // below -- operators (and WPSD's own dashboard) need to know *why* a
@@ -61,6 +66,9 @@ static void writeJSONLinkFailed(const std::string& name, const std::string& reas
 }
 
 CDMRNetwork::CDMRNetwork(const std::string& address, unsigned short port, unsigned short local, unsigned int id, const std::string& password, const std::string& name, bool location, bool debug, bool trunkingEnabled) :
+m_address(address),
+m_port(port),
+m_resolver(nullptr),
 m_addr(),
 m_addrLen(0U),
 m_id(nullptr),
@@ -73,24 +81,39 @@ m_enabled(false),
 m_status(STATUS::WAITING_CONNECT),
 m_retryTimer(1000U, 10U),
 m_timeoutTimer(1000U, 60U),
-m_buffer(nullptr),
+m_batch(nullptr),
+m_batchLengths(nullptr),
+m_batchAddresses(nullptr),
+m_batchTimestamps(nullptr),
+m_rxReads(0U),
+m_rxPackets(0U),
+m_rxLargestBatch(0U),
+m_txLatency(),
 m_salt(nullptr),
-m_rxData(1000U, "DMR Network"),
+m_rxData(RX_SLOTS, "DMR Network"),
 m_options(),
 m_configData(nullptr),
 m_configLen(0U),
 m_beacon(false),
-m_trunkingEnabled(trunkingEnabled)
+m_trunkingEnabled(trunkingEnabled),
+m_connectedSocket(false),
+m_notify(nullptr),
+m_threadPoller(),
+m_rxQueue(nullptr),
+m_txQueue(nullptr),
+m_rxStalled(false),
+m_running(false),
+m_sayGoodbye(false)
 {
 	assert(!address.empty());
 	assert(port > 0U);
 	assert(id > 1000U);
 	assert(!password.empty());
 
-	if (CUDPSocket::lookup(address, port, m_addr, m_addrLen) != 0)
-		m_addrLen = 0U;
-
-	m_buffer   = new unsigned char[BUFFER_LENGTH];
+	m_batch    = new unsigned char[BATCH_LENGTH * BUFFER_LENGTH];
+	m_batchLengths   = new unsigned int[BATCH_LENGTH];
+	m_batchAddresses = new sockaddr_storage[BATCH_LENGTH];
+	m_batchTimestamps = new unsigned long long[BATCH_LENGTH];
 	m_salt     = new unsigned char[sizeof(uint32_t)];
 	m_id       = new uint8_t[4U];
 
@@ -105,10 +128,16 @@ m_trunkingEnabled(trunkingEnabled)
 
 CDMRNetwork::~CDMRNetwork()
 {
-	delete[] m_buffer;
+	delete[] m_batch;
+	delete[] m_batchLengths;
+	delete[] m_batchAddresses;
+	delete[] m_batchTimestamps;
 	delete[] m_salt;
 	delete[] m_id;
 	delete[] m_configData;
+
+	delete m_rxQueue;
+	delete m_txQueue;
 }
 
 void CDMRNetwork::setOptions(const std::string& options)
@@ -125,13 +154,79 @@ void CDMRNetwork::setConfig(const unsigned char* data, unsigned int len)
 	m_configLen = len;
 }
 
+void CDMRNetwork::setPoller(CPoller* poller)
+{
+	m_socket.setPoller(poller);
+}
+
+// Run the socket, login and keepalives on a thread of our own. Received frames are handed to the
+// routing thread through m_rxQueue, waking it via notify, and frames to send come back via m_txQueue.
+void CDMRNetwork::setThreaded(CPoller* notify)
+{
+	assert(notify != nullptr);
+
+	m_notify = notify;
+
+	m_threadPoller.open();
+	m_socket.setPoller(&m_threadPoller);
+
+	m_rxQueue = new CSPSCRing<CDMRData>(QUEUE_LENGTH, "rx");
+	m_txQueue = new CSPSCRing<CNetworkPacket>(QUEUE_LENGTH, "tx");
+}
+
+// Connect the socket to the master, so that the kernel filters out datagrams from anywhere else
+// and the route isn't looked up for each one sent.
+void CDMRNetwork::setConnectedSocket(bool connected)
+{
+	m_connectedSocket = connected;
+}
+
+void CDMRNetwork::setRxOverflow(RING_OVERFLOW overflow)
+{
+	m_rxData.setOverflow(overflow);
+}
+
+// Look up the master's address with the resolver rather than here and now, so that a slow DNS
+// doesn't hold up the other networks, and follow it if it changes.
+void CDMRNetwork::setResolver(CResolver* resolver)
+{
+	m_resolver = resolver;
+}
+
 bool CDMRNetwork::open()
 {
-	if (m_addrLen == 0U) {
-		LogError("%s, Could not lookup the address of the master", m_name.c_str());
-		return false;
+	if (m_resolver == nullptr) {
+		if (CUDPSocket::lookup(m_address, m_port, m_addr, m_addrLen) != 0) {
+			LogError("%s, Could not lookup the address of the master", m_name.c_str());
+			return false;
+		}
+	} else if (!m_resolver->lookup(m_address, m_port, m_addr, m_addrLen)) {
+		// The socket is opened from clock() once the address is known
+		LogMessage("%s, Waiting for the address of the master", m_name.c_str());
+		m_addrLen = 0U;
 	}
 
+	if (m_addrLen > 0U) {
+		bool ret = openSocket();
+		if (!ret)
+			return false;
+	}
+
+	// The timers belong to the network's own thread, so it starts the login itself
+	if ((m_rxQueue != nullptr) && !m_running) {
+		m_running = true;
+		return run();
+	}
+
+	m_status = STATUS::WAITING_CONNECT;
+	m_timeoutTimer.stop();
+	m_retryTimer.start();
+
+	return true;
+}
+
+bool CDMRNetwork::openSocket()
+{
 	LogMessage("%s, Opening DMR Network", m_name.c_str());
 	WriteJSONStatus("Opening DMR Network: " + m_name);
 
@@ -139,16 +234,28 @@ bool CDMRNetwork::open()
 	if (!ret)
 		return false;
 
-	m_status = STATUS::WAITING_CONNECT;
-	m_timeoutTimer.stop();
-	m_retryTimer.start();
+	if (m_connectedSocket && !m_socket.connect(m_addr, m_addrLen))
+		LogWarning("%s, Could not connect the socket to the master, checking the source of each packet instead", m_name.c_str());
 
 	return true;
 }
 
+bool CDMRNetwork::hasMoved()
+{
+	if (m_resolver == nullptr)
+		return false;
+
+	sockaddr_storage addr;
+	unsigned int addrLen;
+	if (!m_resolver->lookup(m_address, m_port, addr, addrLen))
+		return false;
+
+	return !CUDPSocket::match(addr, m_addr);
+}
+
 void CDMRNetwork::enable(bool enabled)
 {
-        if (!enabled && m_enabled)
+        if (!enabled && m_enabled && (m_rxQueue == nullptr))
                 m_rxData.clear();
 
         m_enabled = enabled;
@@ -156,81 +263,100 @@ void CDMRNetwork::enable(bool enabled)
 
 bool CDMRNetwork::read(CDMRData& data)
 {
-	if (m_status != STATUS::RUNNING)
-		return false;
+	if (m_rxQueue == nullptr)
+		return decode(data);
 
-	if (m_rxData.isEmpty())
+	if (!m_enabled) {
+		while (m_rxQueue->pop(data))
+			;
+		resumeRx();
 		return false;
+	}
 
-	unsigned char length = 0U;
+	bool ret = m_rxQueue->pop(data);
+	if (ret)
+		resumeRx();
 
-	m_rxData.getData(&length, 1U);
-	m_rxData.getData(m_buffer, length);
+	return ret;
+}
 
-	if ((::memcmp(m_buffer, "DMRT", 4U) == 0) && m_trunkingEnabled) { // DMRT protocol messages
-		if(data.setMessage(m_buffer, length)) {
-			return true;
-		}
+bool CDMRNetwork::decode(CDMRData& data)
+{
+	if (m_status != STATUS::RUNNING)
 		return false;
-	}
 
-	// Is this a data packet?
-	if (::memcmp(m_buffer, "DMRD", 4U) != 0)
+	unsigned int length = 0U;
+	unsigned long long timestamp = 0ULL;
+	const unsigned char* packet = m_rxData.peek(length, timestamp);
+	if (packet == nullptr)
 		return false;
 
-	unsigned char seqNo = m_buffer[4U];
+	data.setTimestamp(timestamp);
 
-	unsigned int srcId = (m_buffer[5U] << 16) | (m_buffer[6U] << 8) | (m_buffer[7U] << 0);
+	bool ret = false;
+	HOMEBREW_PACKET type = CHomebrewPacket::classify(packet, length);
 
-	unsigned int dstId = (m_buffer[8U] << 16) | (m_buffer[9U] << 8) | (m_buffer[10U] << 0);
+	if ((type == HOMEBREW_PACKET::DMRT) && m_trunkingEnabled) { // DMRT protocol message
+		ret = data.setMessage(packet, length);
+	} else if (type == HOMEBREW_PACKET::DMRD) {
+		// The ring buffer only holds DMRD frames of the two valid lengths, they are left as they arrived
+		unsigned char* buffer = data.getPacket();
+		::memcpy(buffer, packet, length);
 
-	unsigned int slotNo = (m_buffer[15U] & 0x80U) == 0x80U ? 2U : 1U;
+		if ((length != HOMEBREW_TRUNKING_DATA_PACKET_LENGTH) || !m_trunkingEnabled)
+			::memset(buffer + HOMEBREW_DATA_PACKET_LENGTH, 0x00U, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH - HOMEBREW_DATA_PACKET_LENGTH);
 
-	FLCO flco = (m_buffer[15U] & 0x40U) == 0x40U ? FLCO::USER_USER : FLCO::GROUP;
+		ret = true;
+	}
 
-	unsigned int streamId;
-	::memcpy(&streamId, m_buffer + 16U, 4U);
+	m_rxData.pop();
 
-	unsigned char ber  = m_buffer[53U];
+	return ret;
+}
 
-	unsigned char rssi = m_buffer[54U];
+// When blocking, only take as many datagrams as the ring buffer can hold, the rest wait in the socket
+unsigned int CDMRNetwork::getRxSpace() const
+{
+	if ((m_rxData.getOverflow() == RING_OVERFLOW::BLOCK) && (m_rxData.freeSlots() < BATCH_LENGTH))
+		return m_rxData.freeSlots();
 
-	data.setSeqNo(seqNo);
-	data.setSlotNo(slotNo);
-	data.setSrcId(srcId);
-	data.setDstId(dstId);
-	data.setFLCO(flco);
-	data.setStreamId(streamId);
-	data.setBER(ber);
-	data.setRSSI(rssi);
+	return BATCH_LENGTH;
+}
 
-	bool dataSync = (m_buffer[15U] & 0x20U) == 0x20U;
-	bool voiceSync = (m_buffer[15U] & 0x10U) == 0x10U;
+// The network's thread leaves frames in the ring while the receive queue is full, so that the
+// overflow policy applies to them there. It is woken by resumeRx() once the routing thread has taken
+// a frame, and the fences make sure that one of the two threads always sees what the other did.
+bool CDMRNetwork::isRxQueueFull()
+{
+	if (m_rxQueue->space() > 0U)
+		return false;
 
-	if (dataSync) {
-		unsigned char dataType = m_buffer[15U] & 0x0FU;
-		data.setData(m_buffer + 20U);
-		data.setDataType(dataType);
-		data.setN(0U);
-	} else if (voiceSync) {
-		data.setData(m_buffer + 20U);
-		data.setDataType(DT_VOICE_SYNC);
-		data.setN(0U);
-	} else {
-		unsigned char n = m_buffer[15U] & 0x0FU;
-		data.setData(m_buffer + 20U);
-		data.setDataType(DT_VOICE);
-		data.setN(n);
-	}
+	m_rxStalled.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 
-	if((length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH) && m_trunkingEnabled) {
-		unsigned char uuid[16];
-		::memset(uuid, 0, 16U);
-		::memcpy(uuid, m_buffer + 55U, 16U);
-		data.setUUID(uuid);
-	}
+	if (m_rxQueue->space() == 0U)
+		return true;
 
-	return true;
+	m_rxStalled.store(false, std::memory_order_relaxed);
+
+	return false;
+}
+
+void CDMRNetwork::resumeRx()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_rxStalled.load(std::memory_order_relaxed) && m_rxStalled.exchange(false))
+		m_threadPoller.wake();
+}
+
+bool CDMRNetwork::hasData() const
+{
+	if (m_rxQueue != nullptr)
+		return !m_rxQueue->isEmpty();
+
+	// Nothing is read from the ring buffer until the login has completed
+	return (m_status == STATUS::RUNNING) && !m_rxData.isEmpty();
 }
 
 bool CDMRNetwork::write(const CDMRData& data)
@@ -248,64 +374,18 @@ bool CDMRNetwork::write(const CDMRData& data)
 		if (m_debug)
 			CUtils::dump(1U, "Message to Network Transmitted", buffer, length);
 
-		write(buffer, length);
+		send(buffer, length, data.getTimestamp());
 		return true;
 	}
 	const unsigned int buffer_size = m_trunkingEnabled ? HOMEBREW_TRUNKING_DATA_PACKET_LENGTH : HOMEBREW_DATA_PACKET_LENGTH;
+	// The frame goes out as it is apart from our own ID, a copy is only needed as the same frame may
+	// be written to more than one network
 	unsigned char buffer[HOMEBREW_TRUNKING_DATA_PACKET_LENGTH];
-	::memset(buffer, 0x00U, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH);
-
-	buffer[0U]  = 'D';
-	buffer[1U]  = 'M';
-	buffer[2U]  = 'R';
-	buffer[3U]  = 'D';
+	::memcpy(buffer, data.getPacket(), buffer_size);
 
-	unsigned int srcId = data.getSrcId();
-	buffer[5U]  = srcId >> 16;
-	buffer[6U]  = srcId >> 8;
-	buffer[7U]  = srcId >> 0;
+	CDMRPacket(buffer).setRptId(m_id);
 
-	unsigned int dstId = data.getDstId();
-	buffer[8U]  = dstId >> 16;
-	buffer[9U]  = dstId >> 8;
-	buffer[10U] = dstId >> 0;
-
-	::memcpy(buffer + 11U, m_id, 4U);
-
-	unsigned int slotNo = data.getSlotNo();
-
-	buffer[15U] = slotNo == 1U ? 0x00U : 0x80U;
-
-	FLCO flco = data.getFLCO();
-	buffer[15U] |= flco == FLCO::GROUP ? 0x00U : 0x40U;
-
-	unsigned char dataType = data.getDataType();
-	if (dataType == DT_VOICE_SYNC) {
-		buffer[15U] |= 0x10U;
-	} else if (dataType == DT_VOICE) {
-		buffer[15U] |= data.getN();
-	} else {
-		buffer[15U] |= (0x20U | dataType);
-	}
-
-	buffer[4U] = data.getSeqNo();
-
-	unsigned int streamId = data.getStreamId();
-	::memcpy(buffer + 16U, &streamId, 4U);
-
-	data.getData(buffer + 20U);
-
-	buffer[53U] = data.getBER();
-
-	buffer[54U] = data.getRSSI();
-
-	if(m_trunkingEnabled) {
-		unsigned char uuid[16U];
-		data.getUUID(uuid);
-		::memcpy(buffer + 55U, uuid, 16U);
-	}
-
-	write(buffer, buffer_size);
+	send(buffer, buffer_size, data.getTimestamp());
 
 	return true;
 }
@@ -329,7 +409,7 @@ bool CDMRNetwork::writeRadioPosition(const unsigned char* data, unsigned int len
 
 	::memcpy(buffer + 8U, data + 4U, length - 4U);
 
-	return write(buffer, length);
+	return send(buffer, length);
 }
 
 bool CDMRNetwork::writeTalkerAlias(const unsigned char* data, unsigned int length)
@@ -348,7 +428,7 @@ bool CDMRNetwork::writeTalkerAlias(const unsigned char* data, unsigned int lengt
 
 	::memcpy(buffer + 8U, data + 4U, length - 4U);
 
-	return write(buffer, length);
+	return send(buffer, length);
 }
 
 bool CDMRNetwork::writeHomePosition(float latitude, float longitude)
@@ -369,7 +449,36 @@ bool CDMRNetwork::writeHomePosition(float latitude, float longitude)
 
 	::sprintf(buffer + 8U, "%+08.4f%+09.4f", latitude, longitude);
 
-	return write((unsigned char*)buffer, 25U);
+	return send((unsigned char*)buffer, 25U);
+}
+
+void CDMRNetwork::writeStats(nlohmann::json& json)
+{
+	json["name"]             = m_name;
+	json["rx_reads"]         = m_rxReads.load();
+	json["rx_packets"]       = m_rxPackets.load();
+	json["rx_largest_batch"] = m_rxLargestBatch.exchange(0U);
+
+	m_txLatency.writeJSON(json["tx_latency"]);
+
+	if (m_rxQueue != nullptr) {
+		json["rx_queue_depth"]     = m_rxQueue->depth();
+		json["rx_queue_max_depth"] = m_rxQueue->getMaxDepth();
+		json["rx_queue_dropped"]   = m_rxQueue->getDropped();
+		json["tx_queue_depth"]     = m_txQueue->depth();
+		json["tx_queue_max_depth"] = m_txQueue->getMaxDepth();
+		json["tx_queue_dropped"]   = m_txQueue->getDropped();
+	}
+
+	json["rx_ring_slots"]     = m_rxData.getSlots();
+	json["rx_ring_depth"]     = m_rxData.depth();
+	json["rx_ring_max_depth"] = m_rxData.getMaxDepth();
+	json["rx_ring_overflows"] = m_rxData.getOverflows();
+}
+
+void CDMRNetwork::writeLatency(nlohmann::json& json)
+{
+	m_txLatency.writeJSON(json);
 }
 
 bool CDMRNetwork::isConnected() const
@@ -383,6 +492,20 @@ std::string const CDMRNetwork::getName() const
 }
 
 void CDMRNetwork::close(bool sayGoodbye)
+{
+	// Let the network's thread say goodbye and shut down the socket itself
+	if (m_running) {
+		m_sayGoodbye = sayGoodbye;
+		m_running    = false;
+		m_threadPoller.wake();
+		wait();
+		return;
+	}
+
+	disconnect(sayGoodbye);
+}
+
+void CDMRNetwork::disconnect(bool sayGoodbye)
 {
 	LogMessage("%s, Closing DMR Network", m_name.c_str());
 
@@ -398,6 +521,10 @@ void CDMRNetwork::close(bool sayGoodbye)
 
 	m_socket.close();
 
+	// Nothing in the ring belongs to the next connection, and a full one would keep the socket out
+	// of the poll while logging in again
+	m_rxData.clear();
+
 	m_retryTimer.stop();
 	m_timeoutTimer.stop();
 }
@@ -405,8 +532,20 @@ void CDMRNetwork::close(bool sayGoodbye)
 void CDMRNetwork::clock(unsigned int ms)
 {
 	if (m_status == STATUS::WAITING_CONNECT) {
+		// The master may still be sending to the socket from the last connection. Left unread, that
+		// would have the poller return straight away until the login is sent.
+		m_socket.read(m_batch, BUFFER_LENGTH, BATCH_LENGTH, m_batchLengths, m_batchAddresses);
+
 		m_retryTimer.clock(ms);
 		if (m_retryTimer.isRunning() && m_retryTimer.hasExpired()) {
+			if (m_addrLen == 0U) {
+				if (!m_resolver->lookup(m_address, m_port, m_addr, m_addrLen) || !openSocket()) {
+					m_addrLen = 0U;
+					m_retryTimer.start();
+					return;
+				}
+			}
+
 			bool ret = writeLogin();
 			if (!ret)
 				return;
@@ -419,209 +558,41 @@ void CDMRNetwork::clock(unsigned int ms)
 		return;
 	}
 
-	sockaddr_storage address;
-	unsigned int addrlen;
-	int length = m_socket.read(m_buffer, BUFFER_LENGTH, address, addrlen);
-	if (length < 0) {
-		LogError("%s, Socket has failed, retrying connection to the master", m_name.c_str());
-		close(false);
-		open();
-		return;
-	}
+	unsigned int space = getRxSpace();
 
-	if (m_debug && length > 0)
-		CUtils::dump(1U, "Network Received", m_buffer, length);
-
-	if (length > 0 && CUDPSocket::match(m_addr, address)) {
-		if ((::memcmp(m_buffer, "DMRT", 4U) == 0) && (length <= 255) && m_trunkingEnabled && m_enabled) {
-			unsigned char len = length;
-			m_rxData.addData(&len, 1U);
-			m_rxData.addData(m_buffer, len);
-		} else if (::memcmp(m_buffer, "DMRD", 4U) == 0) {
-			if (m_debug)
-				CUtils::dump(1U, "Network Received", m_buffer, length);
-
-			if (m_enabled && ((length == HOMEBREW_DATA_PACKET_LENGTH) || (length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH))) {
-				unsigned char len = length;
-				m_rxData.addData(&len, 1U);
-				m_rxData.addData(m_buffer, len);
-			}
-		} else if (::memcmp(m_buffer, "MSTNAK",  6U) == 0) {
-			if (m_status == STATUS::RUNNING) {
-				LogWarning("%s, Login to the master has failed, retrying login ...", m_name.c_str());
-				WriteJSONStatus("Failed login into DMR Network: " + m_name);
-				writeJSONLinkFailed(m_name, "session");
-				m_status = STATUS::WAITING_LOGIN;
-				m_timeoutTimer.start();
-				m_retryTimer.start();
-			} else {
-				/* Once the modem death spiral has been prevented in Modem.cpp
-				   the Network sometimes times out and reaches here.
-				   We want it to reconnect so... */
-				LogError("%s, Login to the master has failed, retrying network ...", m_name.c_str());
-				WriteJSONStatus("Failed login into DMR Network: " + m_name);
-				// Which handshake stage got NAK'd tells us why: a rejection
-				// during WAITING_AUTHORISATION means the master didn't
-				// accept our hashed password -- almost always a wrong
-				// DMR Network password in the .ini, the single most common
-				// real-world support issue this is meant to surface.
-				writeJSONLinkFailed(m_name, m_status == STATUS::WAITING_AUTHORISATION ? "auth" :
-				                             m_status == STATUS::WAITING_LOGIN        ? "login" : "config");
-				close(false);
-				open();
-				return;
-			}
-		} else if (::memcmp(m_buffer, "RPTACK",  6U) == 0) {
-			switch (m_status) {
-				case STATUS::WAITING_LOGIN:
-					LogDebug("%s, Sending authorisation", m_name.c_str());
-					::memcpy(m_salt, m_buffer + 6U, sizeof(uint32_t));
-					writeAuthorisation();
-					m_status = STATUS::WAITING_AUTHORISATION;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case STATUS::WAITING_AUTHORISATION:
-					LogDebug("%s, Sending configuration", m_name.c_str());
-					writeConfig();
-					m_status = STATUS::WAITING_CONFIG;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case STATUS::WAITING_CONFIG:
-					if (m_options.empty()) {
-						LogMessage("%s, Logged into the master successfully", m_name.c_str());
-						WriteJSONStatus("Logged into DMR Network: " + m_name);
-						m_status = STATUS::RUNNING;
-					} else {
-						LogDebug("%s, Sending options", m_name.c_str());
-						writeOptions();
-						m_status = STATUS::WAITING_OPTIONS;
-					}
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case STATUS::WAITING_OPTIONS:
-					LogMessage("%s, Logged into the master successfully", m_name.c_str());
-					WriteJSONStatus("Logged into DMR Network: " + m_name);
-					m_status = STATUS::RUNNING;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				default:
-					break;
-			}
-		} else if (::memcmp(m_buffer, "MSTCL",   5U) == 0) {
-			LogError("%s, Master is closing down", m_name.c_str());
-			WriteJSONStatus("Connection closing into DMR Network: " + m_name);
-			writeJSONLinkFailed(m_name, "closed");
-			close(false);
+	int count = 0;
+	if (space > 0U) {
+		count = m_socket.read(m_batch, BUFFER_LENGTH, space, m_batchLengths, m_batchAddresses, m_batchTimestamps);
+		if (count < 0) {
+			LogError("%s, Socket has failed, retrying connection to the master", m_name.c_str());
+			disconnect(false);
 			open();
-		} else if (::memcmp(m_buffer, "MSTPONG", 7U) == 0) {
-			m_timeoutTimer.start();
-		} else if (::memcmp(m_buffer, "RPTSBKN", 7U) == 0) {
-			m_beacon = true;
-		} else if ((::memcmp(m_buffer, "DTCNAK",  6U) == 0) && m_trunkingEnabled) {
-			if (m_status == STATUS::RUNNING) {
-				LogWarning("%s, Login to the master via DTC protocol has failed, retrying login ...", m_name.c_str());
-				m_status = STATUS::WAITING_LOGIN;
-				m_timeoutTimer.start();
-				m_retryTimer.start();
-			} else {
-				/* Once the modem death spiral has been prevented in Modem.cpp
-				   the Network sometimes times out and reaches here.
-				   We want it to reconnect so... */
-				LogError("%s, Login to the master via DTC protocol has failed, retrying network ...", m_name.c_str());
-				close(false);
-				open();
-				return;
-			}
-		} else if ((::memcmp(m_buffer, "DTCACK",  6U) == 0) && m_trunkingEnabled) {
-			switch (m_status) {
-				case STATUS::WAITING_LOGIN:
-					LogDebug("%s, Sending DTC authorisation", m_name.c_str());
-					::memcpy(m_salt, m_buffer + 6U, sizeof(uint32_t));
-					writeAuthorisation();
-					m_status = STATUS::WAITING_AUTHORISATION;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case STATUS::WAITING_AUTHORISATION:
-					LogDebug("%s, Sending DTC configuration", m_name.c_str());
-					writeConfig();
-					m_status = STATUS::WAITING_CONFIG;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case STATUS::WAITING_CONFIG:
-				{
-					if (m_options.empty()) {
-						LogMessage("%s, Logged into the master via DTC protocol successfully", m_name.c_str());
-						m_status = STATUS::RUNNING;
-						const unsigned char len = 5U;
-						unsigned char msg_buffer[len];
-						msg_buffer[0U] = 'D';
-						msg_buffer[1U] = 'M';
-						msg_buffer[2U] = 'R';
-						msg_buffer[3U] = 'T';
-						msg_buffer[4U] = 0xC1;
-						m_rxData.addData(&len, 1U);
-						m_rxData.addData(msg_buffer, len);
-					} else {
-						LogDebug("%s, Sending DTC options", m_name.c_str());
-						writeOptions();
-						m_status = STATUS::WAITING_OPTIONS;
-					}
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				}
-				case STATUS::WAITING_OPTIONS:
-				{
-					LogMessage("%s, Logged into the master via DTC protocol successfully", m_name.c_str());
-					m_status = STATUS::RUNNING;
-					const unsigned char len = 5U;
-					unsigned char msg_buffer[len];
-					msg_buffer[0U] = 'D';
-					msg_buffer[1U] = 'M';
-					msg_buffer[2U] = 'R';
-					msg_buffer[3U] = 'T';
-					msg_buffer[4U] = 0xC1;
-					m_rxData.addData(&len, 1U);
-					m_rxData.addData(msg_buffer, len);
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				}
-				default:
-					break;
-			}
-		} else if ((::memcmp(m_buffer, "DTCCL",   5U) == 0) && m_trunkingEnabled) {
-			LogError("%s, Master is closing down", m_name.c_str());
-			const unsigned char len = 5U;
-			unsigned char msg_buffer[len];
-			msg_buffer[0U] = 'D';
-			msg_buffer[1U] = 'M';
-			msg_buffer[2U] = 'R';
-			msg_buffer[3U] = 'T';
-			msg_buffer[4U] = 0xC2;
-			m_rxData.addData(&len, 1U);
-			m_rxData.addData(msg_buffer, len);
-			close(false);
-			open();
-		} else if ((::memcmp(m_buffer, "DTCPONG", 7U) == 0) && m_trunkingEnabled) {
-			m_timeoutTimer.start();
-		} else if ((::memcmp(m_buffer, "DTCSBKN", 7U) == 0) && m_trunkingEnabled) {
-			m_beacon = true;
-		} else {
-			char buffer[100U];
-			::sprintf(buffer, "%s, Unknown packet from the master", m_name.c_str());
-			CUtils::dump(buffer, m_buffer, length);
+			return;
 		}
 	}
 
+	if (count > 0) {
+		m_rxReads++;
+		m_rxPackets += count;
+		if ((unsigned int)count > m_rxLargestBatch)
+			m_rxLargestBatch = count;
+	}
+
+	for (int i = 0; i < count; i++) {
+		bool ret = processPacket(m_batch + i * BUFFER_LENGTH, m_batchLengths[i], m_batchAddresses[i], m_batchTimestamps[i]);
+		if (!ret)
+			return;
+	}
+
 	m_retryTimer.clock(ms);
 	if (m_retryTimer.isRunning() && m_retryTimer.hasExpired()) {
+		if (hasMoved()) {
+			LogMessage("%s, The master has changed address, reconnecting", m_name.c_str());
+			disconnect(false);
+			open();
+			return;
+		}
+
 		switch (m_status) {
 			case STATUS::WAITING_LOGIN:
 				writeLogin();
@@ -650,9 +621,221 @@ void CDMRNetwork::clock(unsigned int ms)
 		LogError("%s, Connection to the master has timed out, retrying connection", m_name.c_str());
 		WriteJSONStatus("Failed connection into DMR Network: " + m_name);
 		writeJSONLinkFailed(m_name, "timeout");
-		close(false);
+		disconnect(false);
+		open();
+	}
+}
+
+// Returns false if the connection to the master was reset while handling the packet, in which
+// case the rest of the batch is stale and must be dropped.
+bool CDMRNetwork::processPacket(const unsigned char* packet, unsigned int length, const sockaddr_storage& address, unsigned long long timestamp)
+{
+	assert(packet != nullptr);
+
+	if (m_debug && length > 0U)
+		CUtils::dump(1U, "Network Received", packet, length);
+
+	if (length == 0U)
+		return true;
+
+	if (!m_socket.isConnected() && !CUDPSocket::match(m_addr, address))
+		return true;
+
+	HOMEBREW_PACKET type = CHomebrewPacket::classify(packet, length);
+
+	if ((type == HOMEBREW_PACKET::DMRT) && (length <= 255U) && m_trunkingEnabled && m_enabled) {
+		addRxData(packet, length, timestamp);
+	} else if (type == HOMEBREW_PACKET::DMRD) {
+		if (m_debug)
+			CUtils::dump(1U, "Network Received", packet, length);
+
+		if (m_enabled && ((length == HOMEBREW_DATA_PACKET_LENGTH) || (length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH))) {
+			addRxData(packet, length, timestamp);
+		}
+	} else if (type == HOMEBREW_PACKET::MSTNAK) {
+		if (m_status == STATUS::RUNNING) {
+			LogWarning("%s, Login to the master has failed, retrying login ...", m_name.c_str());
+			WriteJSONStatus("Failed login into DMR Network: " + m_name);
+			writeJSONLinkFailed(m_name, "session");
+			m_status = STATUS::WAITING_LOGIN;
+			m_timeoutTimer.start();
+			m_retryTimer.start();
+		} else {
+			/* Once the modem death spiral has been prevented in Modem.cpp
+			   the Network sometimes times out and reaches here.
+			   We want it to reconnect so... */
+			LogError("%s, Login to the master has failed, retrying network ...", m_name.c_str());
+			WriteJSONStatus("Failed login into DMR Network: " + m_name);
+			// Which handshake stage got NAK'd tells us why: a rejection
+			// during WAITING_AUTHORISATION means the master didn't
+			// accept our hashed password -- almost always a wrong
+			// DMR Network password in the .ini, the single most common
+			// real-world support issue this is meant to surface.
+			writeJSONLinkFailed(m_name, m_status == STATUS::WAITING_AUTHORISATION ? "auth" :
+			                             m_status == STATUS::WAITING_LOGIN        ? "login" : "config");
+			disconnect(false);
+			open();
+			return false;
+		}
+	} else if (type == HOMEBREW_PACKET::RPTACK) {
+		switch (m_status) {
+			case STATUS::WAITING_LOGIN:
+				LogDebug("%s, Sending authorisation", m_name.c_str());
+				::memcpy(m_salt, packet + 6U, sizeof(uint32_t));
+				writeAuthorisation();
+				m_status = STATUS::WAITING_AUTHORISATION;
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			case STATUS::WAITING_AUTHORISATION:
+				LogDebug("%s, Sending configuration", m_name.c_str());
+				writeConfig();
+				m_status = STATUS::WAITING_CONFIG;
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			case STATUS::WAITING_CONFIG:
+				if (m_options.empty()) {
+					LogMessage("%s, Logged into the master successfully", m_name.c_str());
+					WriteJSONStatus("Logged into DMR Network: " + m_name);
+					m_status = STATUS::RUNNING;
+				} else {
+					LogDebug("%s, Sending options", m_name.c_str());
+					writeOptions();
+					m_status = STATUS::WAITING_OPTIONS;
+				}
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			case STATUS::WAITING_OPTIONS:
+				LogMessage("%s, Logged into the master successfully", m_name.c_str());
+				WriteJSONStatus("Logged into DMR Network: " + m_name);
+				m_status = STATUS::RUNNING;
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			default:
+				break;
+		}
+	} else if (type == HOMEBREW_PACKET::MSTCL) {
+		LogError("%s, Master is closing down", m_name.c_str());
+		WriteJSONStatus("Connection closing into DMR Network: " + m_name);
+		writeJSONLinkFailed(m_name, "closed");
+		disconnect(false);
+		open();
+		return false;
+	} else if (type == HOMEBREW_PACKET::MSTPONG) {
+		m_timeoutTimer.start();
+	} else if (type == HOMEBREW_PACKET::RPTSBKN) {
+		m_beacon = true;
+	} else if ((type == HOMEBREW_PACKET::DTCNAK) && m_trunkingEnabled) {
+		if (m_status == STATUS::RUNNING) {
+			LogWarning("%s, Login to the master via DTC protocol has failed, retrying login ...", m_name.c_str());
+			m_status = STATUS::WAITING_LOGIN;
+			m_timeoutTimer.start();
+			m_retryTimer.start();
+		} else {
+			/* Once the modem death spiral has been prevented in Modem.cpp
+			   the Network sometimes times out and reaches here.
+			   We want it to reconnect so... */
+			LogError("%s, Login to the master via DTC protocol has failed, retrying network ...", m_name.c_str());
+			disconnect(false);
+			open();
+			return false;
+		}
+	} else if ((type == HOMEBREW_PACKET::DTCACK) && m_trunkingEnabled) {
+		switch (m_status) {
+			case STATUS::WAITING_LOGIN:
+				LogDebug("%s, Sending DTC authorisation", m_name.c_str());
+				::memcpy(m_salt, packet + 6U, sizeof(uint32_t));
+				writeAuthorisation();
+				m_status = STATUS::WAITING_AUTHORISATION;
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			case STATUS::WAITING_AUTHORISATION:
+				LogDebug("%s, Sending DTC configuration", m_name.c_str());
+				writeConfig();
+				m_status = STATUS::WAITING_CONFIG;
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			case STATUS::WAITING_CONFIG:
+			{
+				if (m_options.empty()) {
+					LogMessage("%s, Logged into the master via DTC protocol successfully", m_name.c_str());
+					m_status = STATUS::RUNNING;
+					const unsigned char len = 5U;
+					unsigned char msg_buffer[len];
+					msg_buffer[0U] = 'D';
+					msg_buffer[1U] = 'M';
+					msg_buffer[2U] = 'R';
+					msg_buffer[3U] = 'T';
+					msg_buffer[4U] = 0xC1;
+					addRxData(msg_buffer, len, timestamp);
+				} else {
+					LogDebug("%s, Sending DTC options", m_name.c_str());
+					writeOptions();
+					m_status = STATUS::WAITING_OPTIONS;
+				}
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			}
+			case STATUS::WAITING_OPTIONS:
+			{
+				LogMessage("%s, Logged into the master via DTC protocol successfully", m_name.c_str());
+				m_status = STATUS::RUNNING;
+				const unsigned char len = 5U;
+				unsigned char msg_buffer[len];
+				msg_buffer[0U] = 'D';
+				msg_buffer[1U] = 'M';
+				msg_buffer[2U] = 'R';
+				msg_buffer[3U] = 'T';
+				msg_buffer[4U] = 0xC1;
+				addRxData(msg_buffer, len, timestamp);
+				m_timeoutTimer.start();
+				m_retryTimer.start();
+				break;
+			}
+			default:
+				break;
+		}
+	} else if ((type == HOMEBREW_PACKET::DTCCL) && m_trunkingEnabled) {
+		LogError("%s, Master is closing down", m_name.c_str());
+		const unsigned char len = 5U;
+		unsigned char msg_buffer[len];
+		msg_buffer[0U] = 'D';
+		msg_buffer[1U] = 'M';
+		msg_buffer[2U] = 'R';
+		msg_buffer[3U] = 'T';
+		msg_buffer[4U] = 0xC2;
+		addRxData(msg_buffer, len, timestamp);
+		disconnect(false);
 		open();
+		return false;
+	} else if ((type == HOMEBREW_PACKET::DTCPONG) && m_trunkingEnabled) {
+		m_timeoutTimer.start();
+	} else if ((type == HOMEBREW_PACKET::DTCSBKN) && m_trunkingEnabled) {
+		m_beacon = true;
+	} else {
+		char buffer[100U];
+		::sprintf(buffer, "%s, Unknown packet from the master", m_name.c_str());
+		CUtils::dump(buffer, packet, length);
 	}
+
+	return true;
+}
+
+void CDMRNetwork::addRxData(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+
+	// Without a kernel timestamp, this is the closest there is to the arrival time
+	if (timestamp == 0ULL)
+		timestamp = CLatencyHistogram::now();
+
+	m_rxData.add(data, length, timestamp);
 }
 
 bool CDMRNetwork::writeLogin()
@@ -734,11 +917,7 @@ bool CDMRNetwork::writePing()
 
 bool CDMRNetwork::wantsBeacon()
 {
-	bool beacon = m_beacon;
-
-	m_beacon = false;
-
-	return beacon;
+	return m_beacon.exchange(false);
 }
 
 bool CDMRNetwork::write(const unsigned char* data, unsigned int length)
@@ -749,13 +928,104 @@ bool CDMRNetwork::write(const unsigned char* data, unsigned int length)
 	if (m_debug)
 		CUtils::dump(1U, "Network Transmitted", data, length);
 
-	bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+	bool ret = m_socket.queue(data, length, m_addr, m_addrLen);
+	if (!ret) {
+		LogError("%s, Socket has failed when writing data to the master, retrying connection", m_name.c_str());
+		disconnect(false);
+		open();
+		return false;
+	}
+
+	return true;
+}
+
+// Frames from the routing thread go via the network's own thread when it has one
+bool CDMRNetwork::send(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+
+	if (m_txQueue == nullptr) {
+		bool ret = write(data, length);
+		m_txLatency.add(timestamp);
+		return ret;
+	}
+
+	if (length > NETWORK_PACKET_LENGTH)
+		return false;
+
+	CNetworkPacket packet;
+	::memcpy(packet.m_data, data, length);
+	packet.m_length    = length;
+	packet.m_timestamp = timestamp;
+
+	bool ret = m_txQueue->push(packet);
+	if (!ret) {
+		LogWarning("%s, Transmit queue is full, dropping a frame", m_name.c_str());
+		return false;
+	}
+
+	m_threadPoller.wake();
+
+	return true;
+}
+
+bool CDMRNetwork::flush()
+{
+	bool ret = m_socket.flush();
 	if (!ret) {
 		LogError("%s, Socket has failed when writing data to the master, retrying connection", m_name.c_str());
-		close(false);
+		disconnect(false);
 		open();
 		return false;
 	}
 
 	return true;
 }
+
+void CDMRNetwork::entry()
+{
+	m_status = STATUS::WAITING_CONNECT;
+	m_timeoutTimer.stop();
+	m_retryTimer.start();
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	while (m_running) {
+		m_threadPoller.wait(CTimerService::getNextExpiry(IDLE_TIMEOUT));
+
+		CTimerService::clock();
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		CNetworkPacket packet;
+		while (m_txQueue->pop(packet)) {
+			write(packet.m_data, packet.m_length);
+			m_txLatency.add(packet.m_timestamp);
+		}
+
+		clock(ms);
+
+		bool received = false;
+		while ((m_status == STATUS::RUNNING) && !m_rxData.isEmpty() && !isRxQueueFull()) {
+			CDMRData data;
+			if (decode(data)) {
+				m_rxQueue->push(data);
+				received = true;
+			}
+		}
+
+		// With the ring full the socket stays readable, so it is left out of the poll until there is
+		// room again, and until then this thread sleeps until resumeRx() wakes it
+		m_socket.setPolling(getRxSpace() > 0U);
+
+		if (received)
+			m_notify->wake();
+
+		flush();
+	}
+
+	disconnect(m_sayGoodbye);
+}
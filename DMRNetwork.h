@@ -19,15 +19,24 @@
 #if !defined(DMRNetwork_H)
 #define	DMRNetwork_H
 
+#include "LatencyHistogram.h"
+#include "NetworkPacket.h"
 #include "UDPSocket.h"
-#include "Timer.h"
-#include "RingBuffer.h"
+#include "PacketRing.h"
+#include "Resolver.h"
+#include "SPSCRing.h"
 #include "DMRData.h"
+#include "Poller.h"
+#include "Thread.h"
+#include "Timer.h"
 
 #include <string>
+#include <atomic>
 #include <cstdint>
 
-class CDMRNetwork
+#include <nlohmann/json.hpp>
+
+class CDMRNetwork : public CThread
 {
 public:
 	CDMRNetwork(const std::string& address, unsigned short port, unsigned short local, unsigned int id, const std::string& password, const std::string& name, bool location, bool debug, bool trunkingEnabled);
@@ -37,12 +46,24 @@ public:
 
 	void setConfig(const unsigned char* config, unsigned int len);
 
+	void setPoller(CPoller* poller);
+
+	void setThreaded(CPoller* notify);
+
+	void setConnectedSocket(bool connected);
+
+	void setRxOverflow(RING_OVERFLOW overflow);
+
+	void setResolver(CResolver* resolver);
+
 	bool open();
 
 	void enable(bool enabled);
 	
 	bool read(CDMRData& data);
 
+	bool hasData() const;
+
 	bool write(const CDMRData& data);
 
 	bool writeRadioPosition(const unsigned char* data, unsigned int length);
@@ -53,14 +74,24 @@ public:
 
 	bool wantsBeacon();
 
+	bool flush();
+
 	void clock(unsigned int ms);
 
 	bool isConnected() const;
 	std::string const getName() const;
 
+	void writeStats(nlohmann::json& json);
+	void writeLatency(nlohmann::json& json);
+
 	void close(bool sayGoodbye);
 
+	virtual void entry();
+
 private:
+	std::string      m_address;
+	unsigned short   m_port;
+	CResolver*       m_resolver;
 	sockaddr_storage m_addr;
 	unsigned int     m_addrLen;
 	uint8_t*         m_id;
@@ -69,7 +100,7 @@ private:
 	bool             m_location;
 	bool             m_debug;
 	CUDPSocket       m_socket;
-	bool             m_enabled;
+	std::atomic<bool> m_enabled;
 
 	enum class STATUS {
 		WAITING_CONNECT,
@@ -80,21 +111,37 @@ private:
 		RUNNING
 	};
 
-	STATUS         m_status;
+	std::atomic<STATUS> m_status;
 	CTimer         m_retryTimer;
 	CTimer         m_timeoutTimer;
-	unsigned char* m_buffer;
+	unsigned char* m_batch;
+	unsigned int*  m_batchLengths;
+	sockaddr_storage* m_batchAddresses;
+	unsigned long long* m_batchTimestamps;
+	std::atomic<unsigned int> m_rxReads;
+	std::atomic<unsigned int> m_rxPackets;
+	std::atomic<unsigned int> m_rxLargestBatch;
+	CLatencyHistogram m_txLatency;
 	unsigned char* m_salt;
 
-	CRingBuffer<unsigned char> m_rxData;
+	CPacketRing    m_rxData;
 
 	std::string    m_options;
 
 	unsigned char* m_configData;
 	unsigned int   m_configLen;
 
-	bool           m_beacon;
+	std::atomic<bool> m_beacon;
 	bool           m_trunkingEnabled;
+	bool           m_connectedSocket;
+
+	CPoller*                   m_notify;
+	CPoller                    m_threadPoller;
+	CSPSCRing<CDMRData>*       m_rxQueue;
+	CSPSCRing<CNetworkPacket>* m_txQueue;
+	std::atomic<bool>          m_rxStalled;
+	std::atomic<bool>          m_running;
+	bool                       m_sayGoodbye;
 
 	bool writeLogin();
 	bool writeAuthorisation();
@@ -102,6 +149,19 @@ private:
 	bool writeConfig();
 	bool writePing();
 
+	bool processPacket(const unsigned char* packet, unsigned int length, const sockaddr_storage& address, unsigned long long timestamp);
+	void addRxData(const unsigned char* data, unsigned int length, unsigned long long timestamp);
+
+	bool openSocket();
+	bool hasMoved();
+
+	bool decode(CDMRData& data);
+	unsigned int getRxSpace() const;
+	bool isRxQueueFull();
+	void resumeRx();
+	bool send(const unsigned char* data, unsigned int length, unsigned long long timestamp = 0ULL);
+	void disconnect(bool sayGoodbye);
+
 	bool write(const unsigned char* data, unsigned int length);
 };
 
@@ -0,0 +1,207 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DMRPacket_H)
+#define	DMRPacket_H
+
+#include "DMRDefines.h"
+
+#include <cassert>
+#include <cstring>
+
+const unsigned int HOMEBREW_DATA_PACKET_LENGTH          = 55U;
+const unsigned int HOMEBREW_TRUNKING_DATA_PACKET_LENGTH = 71U; // DMRD with 16 byte UUID extension
+
+// A view over a homebrew DMRD frame laid out as it is on the wire. The fields are read and
+// changed in the caller's buffer, so a frame can be rewritten and passed on without being taken
+// apart and built again. Byte 15 holds the slot, the call type and either the voice sequence
+// letter or the data type, so changing the data type keeps the voice sequence only when going
+// from one voice frame to another.
+class CDMRPacket {
+public:
+	CDMRPacket(unsigned char* buffer) :
+	m_buffer(buffer)
+	{
+		assert(buffer != nullptr);
+	}
+
+	unsigned char getSeqNo() const
+	{
+		return m_buffer[4U];
+	}
+
+	void setSeqNo(unsigned char seqNo)
+	{
+		m_buffer[4U] = seqNo;
+	}
+
+	unsigned int getSrcId() const
+	{
+		return (m_buffer[5U] << 16) | (m_buffer[6U] << 8) | (m_buffer[7U] << 0);
+	}
+
+	void setSrcId(unsigned int id)
+	{
+		m_buffer[5U] = id >> 16;
+		m_buffer[6U] = id >> 8;
+		m_buffer[7U] = id >> 0;
+	}
+
+	unsigned int getDstId() const
+	{
+		return (m_buffer[8U] << 16) | (m_buffer[9U] << 8) | (m_buffer[10U] << 0);
+	}
+
+	void setDstId(unsigned int id)
+	{
+		m_buffer[8U]  = id >> 16;
+		m_buffer[9U]  = id >> 8;
+		m_buffer[10U] = id >> 0;
+	}
+
+	void setRptId(unsigned int id)
+	{
+		m_buffer[11U] = id >> 24;
+		m_buffer[12U] = id >> 16;
+		m_buffer[13U] = id >> 8;
+		m_buffer[14U] = id >> 0;
+	}
+
+	void setRptId(const unsigned char* id)
+	{
+		assert(id != nullptr);
+
+		::memcpy(m_buffer + 11U, id, 4U);
+	}
+
+	unsigned int getSlotNo() const
+	{
+		return (m_buffer[15U] & 0x80U) == 0x80U ? 2U : 1U;
+	}
+
+	void setSlotNo(unsigned int slotNo)
+	{
+		assert(slotNo == 1U || slotNo == 2U);
+
+		if (slotNo == 1U)
+			m_buffer[15U] &= 0x7FU;
+		else
+			m_buffer[15U] |= 0x80U;
+	}
+
+	FLCO getFLCO() const
+	{
+		return (m_buffer[15U] & 0x40U) == 0x40U ? FLCO::USER_USER : FLCO::GROUP;
+	}
+
+	void setFLCO(FLCO flco)
+	{
+		if (flco == FLCO::GROUP)
+			m_buffer[15U] &= 0xBFU;
+		else
+			m_buffer[15U] |= 0x40U;
+	}
+
+	unsigned char getDataType() const
+	{
+		if ((m_buffer[15U] & 0x20U) == 0x20U)
+			return m_buffer[15U] & 0x0FU;
+		else if ((m_buffer[15U] & 0x10U) == 0x10U)
+			return DT_VOICE_SYNC;
+		else
+			return DT_VOICE;
+	}
+
+	void setDataType(unsigned char dataType)
+	{
+		unsigned char n = isVoice() ? (m_buffer[15U] & 0x0FU) : 0x00U;
+
+		m_buffer[15U] &= 0xC0U;
+
+		if (dataType == DT_VOICE_SYNC)
+			m_buffer[15U] |= 0x10U;
+		else if (dataType == DT_VOICE)
+			m_buffer[15U] |= n;
+		else
+			m_buffer[15U] |= (0x20U | (dataType & 0x0FU));
+	}
+
+	unsigned char getN() const
+	{
+		return isVoice() ? (m_buffer[15U] & 0x0FU) : 0U;
+	}
+
+	// Only a voice frame without a sync carries the sequence letter
+	void setN(unsigned char n)
+	{
+		if (isVoice())
+			m_buffer[15U] = (m_buffer[15U] & 0xF0U) | (n & 0x0FU);
+	}
+
+	unsigned int getStreamId() const
+	{
+		unsigned int id;
+		::memcpy(&id, m_buffer + 16U, sizeof(unsigned int));
+		return id;
+	}
+
+	void setStreamId(unsigned int id)
+	{
+		::memcpy(m_buffer + 16U, &id, sizeof(unsigned int));
+	}
+
+	unsigned char* getPayload() const
+	{
+		return m_buffer + 20U;
+	}
+
+	unsigned char getBER() const
+	{
+		return m_buffer[53U];
+	}
+
+	void setBER(unsigned char ber)
+	{
+		m_buffer[53U] = ber;
+	}
+
+	unsigned char getRSSI() const
+	{
+		return m_buffer[54U];
+	}
+
+	void setRSSI(unsigned char rssi)
+	{
+		m_buffer[54U] = rssi;
+	}
+
+	unsigned char* getUUID() const
+	{
+		return m_buffer + 55U;
+	}
+
+private:
+	unsigned char* m_buffer;
+
+	bool isVoice() const
+	{
+		return (m_buffer[15U] & 0x30U) == 0x00U;
+	}
+};
+
+#endif
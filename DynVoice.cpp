@@ -23,6 +23,7 @@
 #include "Sync.h"
 #include "Log.h"
 
+#include <cassert>
 #include <cstring>
 #include <cstdlib>
 
@@ -35,7 +36,7 @@ const unsigned char COLOR_CODE = 3U;
 const unsigned int SILENCE_LENGTH = 9U;
 const unsigned int AMBE_LENGTH = 9U;
 
-CDynVoice::CDynVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg) :
+CDynVoice::CDynVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg, CDMRDataPool* pool) :
 m_indxFile(),
 m_ambeFile(),
 m_id(id),
@@ -49,10 +50,14 @@ m_seqNo(0U),
 m_streamId(0U),
 m_sent(0U),
 m_ambe(nullptr),
+m_ambeData(),
 m_positions(),
+m_pool(pool),
 m_data(),
 m_it()
 {
+	assert(pool != nullptr);
+
 #if defined(_WIN32) || defined(_WIN64)
 	m_indxFile = directory + "\\" + language + ".indx";
 	m_ambeFile = directory + "\\" + language + ".ambe";
@@ -70,13 +75,11 @@ m_it()
 
 CDynVoice::~CDynVoice()
 {
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete *it;
+	m_pool->put(m_data);
 
 	for (std::unordered_map<std::string, CDynPositions*>::iterator it = m_positions.begin(); it != m_positions.end(); ++it)
 		delete it->second;
 
-	m_data.clear();
 	m_positions.clear();
 
 	delete[] m_ambe;
@@ -164,10 +167,8 @@ void CDynVoice::unlinked()
 
 void CDynVoice::abort()
 {
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete* it;
+	m_pool->put(m_data);
 
-	m_data.clear();
 	m_timer.stop();
 
 	m_status = DYNVOICE_STATUS::NONE;
@@ -196,7 +197,8 @@ void CDynVoice::createVoice(const std::vector<std::string>& words)
 	ambeLength += SILENCE_LENGTH * AMBE_LENGTH;
 	ambeLength += SILENCE_LENGTH * AMBE_LENGTH;
 
-	unsigned char* ambeData = new unsigned char[ambeLength];
+	m_ambeData.resize(ambeLength);
+	unsigned char* ambeData = m_ambeData.data();
 
 	// Fill the AMBE data with silence
 	for (unsigned int i = 0U; i < ambeLength; i += AMBE_LENGTH)
@@ -214,10 +216,7 @@ void CDynVoice::createVoice(const std::vector<std::string>& words)
 		}
 	}
 		
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete *it;
-
-	m_data.clear();
+	m_pool->put(m_data);
 
 	m_streamId = ::rand() + 1U;
 	m_seqNo = 0U;
@@ -232,7 +231,7 @@ void CDynVoice::createVoice(const std::vector<std::string>& words)
 	for (unsigned int i = 0U; i < ambeLength; i += (3U * AMBE_LENGTH)) {
 		unsigned char* p = ambeData + i;
 
-		CDMRData* data = new CDMRData;
+		CDMRData* data = m_pool->get();
 
 		data->setSlotNo(m_slot);
 		data->setFLCO(FLCO::GROUP);
@@ -274,8 +273,6 @@ void CDynVoice::createVoice(const std::vector<std::string>& words)
 	createHeaderTerminator(DT_TERMINATOR_WITH_LC);
 	createHeaderTerminator(DT_TERMINATOR_WITH_LC);
 
-	delete[] ambeData;
-
 	m_status = DYNVOICE_STATUS::WAITING;
 	m_timer.start();
 }
@@ -294,9 +291,7 @@ bool CDynVoice::read(CDMRData& data)
 		++m_it;
 
 		if (m_it == m_data.end()) {
-			for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-				delete *it;
-			m_data.clear();
+			m_pool->put(m_data);
 			m_timer.stop();
 			m_status = DYNVOICE_STATUS::NONE;
 		}
@@ -307,6 +302,11 @@ bool CDynVoice::read(CDMRData& data)
 	return false;
 }
 
+bool CDynVoice::isBusy() const
+{
+	return m_status != DYNVOICE_STATUS::NONE;
+}
+
 void CDynVoice::clock(unsigned int ms)
 {
 	m_timer.clock(ms);
@@ -322,7 +322,7 @@ void CDynVoice::clock(unsigned int ms)
 
 void CDynVoice::createHeaderTerminator(unsigned char type)
 {
-	CDMRData* data = new CDMRData;
+	CDMRData* data = m_pool->get();
 
 	data->setSlotNo(m_slot);
 	data->setFLCO(FLCO::GROUP);
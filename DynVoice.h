@@ -20,6 +20,7 @@
 #define	DynVoice_H
 
 #include "DMREmbeddedData.h"
+#include "DMRDataPool.h"
 #include "StopWatch.h"
 #include "DMRData.h"
 #include "DMRLC.h"
@@ -42,7 +43,7 @@ struct CDynPositions {
 
 class CDynVoice {
 public:
-	CDynVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg);
+	CDynVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg, CDMRDataPool* pool);
 	~CDynVoice();
 
 	bool open();
@@ -52,6 +53,8 @@ public:
 
 	bool read(CDMRData& data);
 
+	bool isBusy() const;
+
 	void abort();
 
 	void clock(unsigned int ms);
@@ -70,7 +73,9 @@ private:
 	unsigned int                           m_streamId;
 	unsigned int                           m_sent;
 	unsigned char*                         m_ambe;
+	std::vector<unsigned char>             m_ambeData;
 	std::unordered_map<std::string, CDynPositions*> m_positions;
+	CDMRDataPool*                          m_pool;
 	std::vector<CDMRData*>                 m_data;
 	std::vector<CDMRData*>::const_iterator m_it;
 
@@ -0,0 +1,130 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "FramePacer.h"
+#include "DMRDefines.h"
+#include "DMRPacket.h"
+
+#include <cassert>
+#include <cstring>
+
+// A frame only counts as late once the repeater will have noticed the gap
+const unsigned int LATE_TOLERANCE = DMR_SLOT_TIME / 2U;
+
+CFramePacer::CFramePacer(unsigned int slotNo, unsigned int depth) :
+m_slotNo(slotNo),
+m_frames(depth, "Frame Pacer"),
+m_streamId(0U),
+m_next(0ULL),
+m_timer(1000U),
+m_late(0U),
+m_early(0U),
+m_dropped(0U)
+{
+	assert(slotNo == 1U || slotNo == 2U);
+	assert(depth > 0U);
+}
+
+CFramePacer::~CFramePacer()
+{
+}
+
+void CFramePacer::add(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+	assert(length >= 20U && length <= HOMEBREW_TRUNKING_DATA_PACKET_LENGTH);
+
+	unsigned long long now = CTimerService::time();
+
+	unsigned int streamId = 0U;
+	::memcpy(&streamId, data + 16U, sizeof(unsigned int));
+
+	if (streamId != m_streamId) {
+		m_streamId = streamId;
+
+		// A new stream starts straight away, unless the last one is still going out
+		if (m_frames.isEmpty())
+			m_next = now;
+	} else if (m_frames.isEmpty() && now > m_next) {
+		// Its turn has gone, so send it now and keep time from it
+		if (now > (m_next + LATE_TOLERANCE))
+			m_late++;
+		m_next = now;
+	}
+
+	if (!m_frames.isEmpty() || now < m_next)
+		m_early++;
+
+	// Make room by losing the oldest frame, which keeps the delay through the pacer bounded
+	if (m_frames.isFull()) {
+		m_dropped++;
+		m_frames.pop();
+	}
+
+	m_frames.add(data, length, timestamp);
+}
+
+bool CFramePacer::get(unsigned char* data, unsigned int& length, unsigned long long& timestamp)
+{
+	assert(data != nullptr);
+
+	unsigned int len = 0U;
+	unsigned long long ts = 0ULL;
+	const unsigned char* frame = m_frames.peek(len, ts);
+	if (frame == nullptr)
+		return false;
+
+	unsigned long long now = CTimerService::time();
+	if (now < m_next) {
+		if (!m_timer.isRunning())
+			m_timer.start(0U, (unsigned int)(m_next - now));
+		return false;
+	}
+
+	m_timer.stop();
+
+	::memcpy(data, frame, len);
+	length    = len;
+	timestamp = ts;
+
+	m_frames.pop();
+
+	// After a stall, keep time from now rather than rushing out the frames that are waiting
+	if (now > m_next)
+		m_next = now;
+	m_next += DMR_SLOT_TIME;
+
+	return true;
+}
+
+void CFramePacer::reset()
+{
+	m_timer.stop();
+	m_frames.clear();
+
+	m_streamId = 0U;
+	m_next     = 0ULL;
+}
+
+void CFramePacer::writeStats(nlohmann::json& json)
+{
+	json["slot"]    = m_slotNo;
+	json["late"]    = (unsigned int)m_late;
+	json["early"]   = (unsigned int)m_early;
+	json["dropped"] = (unsigned int)m_dropped;
+}
@@ -0,0 +1,60 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(FramePacer_H)
+#define	FramePacer_H
+
+#include "PacketRing.h"
+#include "Timer.h"
+
+#include <atomic>
+
+#include <nlohmann/json.hpp>
+
+// Releases the encoded DMRD frames for one slot to the repeater no faster than one every
+// DMR_SLOT_TIME, the rate at which the slot goes out over the air. A burst of frames from the
+// network is held back and let out at that rate, while a frame arriving after its turn goes
+// straight out and the cadence starts again from it, so the delay never builds up. The first
+// frame of a new stream is never held back unless the previous stream is still being let out.
+// Must only be used from one thread, apart from writeStats().
+class CFramePacer {
+public:
+	CFramePacer(unsigned int slotNo, unsigned int depth);
+	~CFramePacer();
+
+	void add(const unsigned char* data, unsigned int length, unsigned long long timestamp);
+
+	// Returns the next frame if its time has come, otherwise makes sure the thread is woken for it.
+	bool get(unsigned char* data, unsigned int& length, unsigned long long& timestamp);
+
+	void reset();
+
+	void writeStats(nlohmann::json& json);
+
+private:
+	unsigned int               m_slotNo;
+	CPacketRing                m_frames;
+	unsigned int               m_streamId;
+	unsigned long long         m_next;
+	CTimer                     m_timer;
+	std::atomic<unsigned int>  m_late;
+	std::atomic<unsigned int>  m_early;
+	std::atomic<unsigned int>  m_dropped;
+};
+
+#endif
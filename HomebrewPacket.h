@@ -0,0 +1,122 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(HomebrewPacket_H)
+#define	HomebrewPacket_H
+
+#include <cassert>
+#include <cstring>
+
+enum class HOMEBREW_PACKET {
+	UNKNOWN,
+	DMRD,
+	DMRT,
+	DMRG,
+	DMRA,
+	DMRP,
+	MSTNAK,
+	MSTCL,
+	MSTPONG,
+	RPTACK,
+	RPTSBKN,
+	DTCNAK,
+	DTCACK,
+	DTCCL,
+	DTCPONG,
+	DTCSBKN
+};
+
+const unsigned int HOMEBREW_TAG_DMRG = 0x444D5247U;	// "DMRG"
+const unsigned int HOMEBREW_TAG_DMRA = 0x444D5241U;	// "DMRA"
+const unsigned int HOMEBREW_TAG_DMRP = 0x444D5250U;	// "DMRP"
+const unsigned int HOMEBREW_TAG_MSTN = 0x4D53544EU;	// "MSTN"
+const unsigned int HOMEBREW_TAG_MSTC = 0x4D535443U;	// "MSTC"
+const unsigned int HOMEBREW_TAG_MSTP = 0x4D535450U;	// "MSTP"
+const unsigned int HOMEBREW_TAG_RPTA = 0x52505441U;	// "RPTA"
+const unsigned int HOMEBREW_TAG_RPTS = 0x52505453U;	// "RPTS"
+const unsigned int HOMEBREW_TAG_DTCN = 0x4454434EU;	// "DTCN"
+const unsigned int HOMEBREW_TAG_DTCA = 0x44544341U;	// "DTCA"
+const unsigned int HOMEBREW_TAG_DTCC = 0x44544343U;	// "DTCC"
+const unsigned int HOMEBREW_TAG_DTCP = 0x44544350U;	// "DTCP"
+const unsigned int HOMEBREW_TAG_DTCS = 0x44544353U;	// "DTCS"
+
+// Tells the homebrew packets apart by their first four bytes taken as one number, looking at the
+// rest of the name only where the first four bytes are shared. A packet too short to hold its
+// whole name is unknown.
+class CHomebrewPacket {
+public:
+	static HOMEBREW_PACKET classify(const unsigned char* packet, unsigned int length)
+	{
+		assert(packet != nullptr);
+
+		if (length < 4U)
+			return HOMEBREW_PACKET::UNKNOWN;
+
+		// Nearly every packet is a voice or data frame, or a trunking message, so each of those is
+		// found with a single four byte compare, before the tag is put together for the switch
+		if (::memcmp(packet, "DMRD", 4U) == 0)
+			return HOMEBREW_PACKET::DMRD;
+		if (::memcmp(packet, "DMRT", 4U) == 0)
+			return HOMEBREW_PACKET::DMRT;
+
+		unsigned int tag = (packet[0U] << 24) | (packet[1U] << 16) | (packet[2U] << 8) | (packet[3U] << 0);
+
+		switch (tag) {
+		case HOMEBREW_TAG_DMRG:
+			return HOMEBREW_PACKET::DMRG;
+		case HOMEBREW_TAG_DMRA:
+			return HOMEBREW_PACKET::DMRA;
+		case HOMEBREW_TAG_DMRP:
+			return HOMEBREW_PACKET::DMRP;
+		case HOMEBREW_TAG_MSTN:
+			return match(packet, length, "AK",  2U, HOMEBREW_PACKET::MSTNAK);
+		case HOMEBREW_TAG_MSTC:
+			return match(packet, length, "L",   1U, HOMEBREW_PACKET::MSTCL);
+		case HOMEBREW_TAG_MSTP:
+			return match(packet, length, "ONG", 3U, HOMEBREW_PACKET::MSTPONG);
+		case HOMEBREW_TAG_RPTA:
+			return match(packet, length, "CK",  2U, HOMEBREW_PACKET::RPTACK);
+		case HOMEBREW_TAG_RPTS:
+			return match(packet, length, "BKN", 3U, HOMEBREW_PACKET::RPTSBKN);
+		case HOMEBREW_TAG_DTCN:
+			return match(packet, length, "AK",  2U, HOMEBREW_PACKET::DTCNAK);
+		case HOMEBREW_TAG_DTCA:
+			return match(packet, length, "CK",  2U, HOMEBREW_PACKET::DTCACK);
+		case HOMEBREW_TAG_DTCC:
+			return match(packet, length, "L",   1U, HOMEBREW_PACKET::DTCCL);
+		case HOMEBREW_TAG_DTCP:
+			return match(packet, length, "ONG", 3U, HOMEBREW_PACKET::DTCPONG);
+		case HOMEBREW_TAG_DTCS:
+			return match(packet, length, "BKN", 3U, HOMEBREW_PACKET::DTCSBKN);
+		default:
+			return HOMEBREW_PACKET::UNKNOWN;
+		}
+	}
+
+private:
+	// Checks the rest of the name after the first four bytes
+	static HOMEBREW_PACKET match(const unsigned char* packet, unsigned int length, const char* rest, unsigned int n, HOMEBREW_PACKET type)
+	{
+		if ((length < (4U + n)) || (::memcmp(packet + 4U, rest, n) != 0))
+			return HOMEBREW_PACKET::UNKNOWN;
+
+		return type;
+	}
+};
+
+#endif
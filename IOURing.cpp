@@ -0,0 +1,340 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "IOURing.h"
+
+#if defined(USE_IO_URING) && defined(__linux__)
+
+#include "Log.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+const unsigned int RX_ENTRIES   = 8U;
+const unsigned int TX_ENTRIES   = 32U;
+
+// Each provided buffer holds the recvmsg header, the source address, the receive timestamp and the datagram
+const unsigned int CONTROL_LENGTH = CMSG_SPACE(sizeof(struct timespec));
+const unsigned int BUFFER_COUNT   = 64U;
+const unsigned int BUFFER_LENGTH  = sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_storage) + CONTROL_LENGTH + 512U;
+const unsigned short BUFFER_GROUP = 0U;
+
+CIOURing::CIOURing() :
+m_fd(-1),
+m_rx(),
+m_tx(),
+m_rxOpen(false),
+m_txOpen(false),
+m_bufRing(nullptr),
+m_buffers(nullptr),
+m_rxMsg(),
+m_txMsgs(nullptr),
+m_txIovecs(nullptr),
+m_armed(false)
+{
+	m_txMsgs   = new struct msghdr[TX_ENTRIES];
+	m_txIovecs = new struct iovec[TX_ENTRIES];
+}
+
+CIOURing::~CIOURing()
+{
+	close();
+
+	delete[] m_txMsgs;
+	delete[] m_txIovecs;
+}
+
+bool CIOURing::open(int fd)
+{
+	assert(fd >= 0);
+
+	m_fd = fd;
+
+	// Size the completion queue so that every provided buffer can be waiting in it at once, a
+	// multishot receive is cancelled if the completion queue overflows
+	struct io_uring_params params;
+	::memset(&params, 0x00U, sizeof(struct io_uring_params));
+	params.flags      = IORING_SETUP_CQSIZE;
+	params.cq_entries = 2U * BUFFER_COUNT;
+
+	int ret = ::io_uring_queue_init_params(RX_ENTRIES, &m_rx, &params);
+	if (ret < 0) {
+		LogError("Cannot create the io_uring receive ring, err: %d", -ret);
+		close();
+		return false;
+	}
+
+	m_rxOpen = true;
+
+	ret = ::io_uring_queue_init(TX_ENTRIES, &m_tx, 0U);
+	if (ret < 0) {
+		LogError("Cannot create the io_uring send ring, err: %d", -ret);
+		close();
+		return false;
+	}
+
+	m_txOpen = true;
+
+	m_bufRing = ::io_uring_setup_buf_ring(&m_rx, BUFFER_COUNT, BUFFER_GROUP, 0U, &ret);
+	if (m_bufRing == nullptr) {
+		LogError("Cannot register the io_uring provided buffers, err: %d", -ret);
+		close();
+		return false;
+	}
+
+	m_buffers = new unsigned char[BUFFER_COUNT * BUFFER_LENGTH];
+
+	for (unsigned int i = 0U; i < BUFFER_COUNT; i++)
+		::io_uring_buf_ring_add(m_bufRing, m_buffers + i * BUFFER_LENGTH, BUFFER_LENGTH, i, ::io_uring_buf_ring_mask(BUFFER_COUNT), i);
+	::io_uring_buf_ring_advance(m_bufRing, BUFFER_COUNT);
+
+	::memset(&m_rxMsg, 0x00U, sizeof(struct msghdr));
+	m_rxMsg.msg_namelen    = sizeof(sockaddr_storage);
+	m_rxMsg.msg_controllen = CONTROL_LENGTH;
+
+	if (!arm()) {
+		close();
+		return false;
+	}
+
+	// An unsupported request completes straight away, so check for one before relying on the ring
+	struct io_uring_cqe* cqe = nullptr;
+	if (::io_uring_peek_cqe(&m_rx, &cqe) == 0 && cqe->res < 0 && (cqe->flags & IORING_CQE_F_MORE) == 0U) {
+		LogError("The multishot io_uring receive is not supported, err: %d", -cqe->res);
+		::io_uring_cqe_seen(&m_rx, cqe);
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+int CIOURing::getFd() const
+{
+	assert(m_rxOpen);
+
+	return m_rx.ring_fd;
+}
+
+unsigned long long CIOURing::getTimestamp(struct io_uring_recvmsg_out* out)
+{
+	for (struct cmsghdr* cmsg = ::io_uring_recvmsg_cmsg_firsthdr(out, &m_rxMsg); cmsg != nullptr; cmsg = ::io_uring_recvmsg_cmsg_nexthdr(out, &m_rxMsg, cmsg)) {
+		if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS)) {
+			struct timespec ts;
+			::memcpy(&ts, CMSG_DATA(cmsg), sizeof(struct timespec));
+			return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+		}
+	}
+
+	return 0ULL;
+}
+
+bool CIOURing::arm()
+{
+	struct io_uring_sqe* sqe = ::io_uring_get_sqe(&m_rx);
+	if (sqe == nullptr)
+		return false;
+
+	::io_uring_prep_recvmsg_multishot(sqe, m_fd, &m_rxMsg, 0U);
+	sqe->flags    |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = BUFFER_GROUP;
+
+	int ret = ::io_uring_submit(&m_rx);
+	if (ret < 0) {
+		LogError("Error returned from io_uring_submit, err: %d", -ret);
+		return false;
+	}
+
+	m_armed = true;
+
+	return true;
+}
+
+// Hand back up to count of the completed receives, each copied into its own length sized slot in
+// buffer, and return the buffers they used to the kernel.
+int CIOURing::read(unsigned char* buffer, unsigned int length, unsigned int count, unsigned int* lengths, sockaddr_storage* addresses, unsigned int* addressLengths, unsigned long long* timestamps)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+	assert(count > 0U);
+	assert(lengths != nullptr);
+	assert(addresses != nullptr);
+
+	if (!m_rxOpen)
+		return 0;
+
+	unsigned int n     = 0U;
+	unsigned int seen  = 0U;
+	unsigned int added = 0U;
+
+	unsigned int head;
+	struct io_uring_cqe* cqe;
+	io_uring_for_each_cqe(&m_rx, head, cqe) {
+		if (n == count)
+			break;
+
+		seen++;
+
+		if ((cqe->flags & IORING_CQE_F_MORE) == 0U)
+			m_armed = false;
+
+		if (cqe->res < 0) {
+			// Running out of buffers only stops the receive, it is started again below, and a
+			// connected socket reports an unreachable peer
+			if (cqe->res != -ENOBUFS && cqe->res != -ECONNREFUSED)
+				LogError("Error returned from the io_uring receive, err: %d", -cqe->res);
+			continue;
+		}
+
+		if ((cqe->flags & IORING_CQE_F_BUFFER) == 0U)
+			continue;
+
+		unsigned short id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		unsigned char* p  = m_buffers + id * BUFFER_LENGTH;
+
+		struct io_uring_recvmsg_out* out = ::io_uring_recvmsg_validate(p, cqe->res, &m_rxMsg);
+		if (out != nullptr) {
+			unsigned int len = ::io_uring_recvmsg_payload_length(out, cqe->res, &m_rxMsg);
+			if (len > length)
+				len = length;
+
+			unsigned int addressLength = out->namelen;
+			if (addressLength > sizeof(sockaddr_storage))
+				addressLength = sizeof(sockaddr_storage);
+
+			::memcpy(buffer + n * length, ::io_uring_recvmsg_payload(out, &m_rxMsg), len);
+			::memcpy(&addresses[n], ::io_uring_recvmsg_name(out), addressLength);
+			lengths[n] = len;
+			if (addressLengths != nullptr)
+				addressLengths[n] = addressLength;
+			if (timestamps != nullptr)
+				timestamps[n] = getTimestamp(out);
+			n++;
+		}
+
+		::io_uring_buf_ring_add(m_bufRing, p, BUFFER_LENGTH, id, ::io_uring_buf_ring_mask(BUFFER_COUNT), added++);
+	}
+
+	if (added > 0U)
+		::io_uring_buf_ring_advance(m_bufRing, added);
+
+	if (seen > 0U)
+		::io_uring_cq_advance(&m_rx, seen);
+
+	if (!m_armed) {
+		if (!arm())
+			return (n > 0U) ? int(n) : -1;
+	}
+
+	return int(n);
+}
+
+// Send count datagrams, each held in its own slotLength sized slot in buffer, with one submission
+// and wait for them all to complete. Without addresses they go to the socket's connected peer.
+bool CIOURing::write(const unsigned char* buffer, unsigned int slotLength, unsigned int count, const unsigned int* lengths, const sockaddr_storage* addresses, const unsigned int* addressLengths)
+{
+	assert(buffer != nullptr);
+	assert(lengths != nullptr);
+	assert(addressLengths != nullptr);
+
+	if (!m_txOpen)
+		return false;
+
+	bool result = true;
+
+	unsigned int sent = 0U;
+	while (sent < count) {
+		unsigned int n = count - sent;
+		if (n > TX_ENTRIES)
+			n = TX_ENTRIES;
+
+		for (unsigned int i = 0U; i < n; i++) {
+			unsigned int j = sent + i;
+
+			m_txIovecs[i].iov_base = (void*)(buffer + j * slotLength);
+			m_txIovecs[i].iov_len  = lengths[j];
+
+			::memset(&m_txMsgs[i], 0x00U, sizeof(struct msghdr));
+			if (addresses != nullptr) {
+				m_txMsgs[i].msg_name    = (void*)&addresses[j];
+				m_txMsgs[i].msg_namelen = addressLengths[j];
+			}
+			m_txMsgs[i].msg_iov     = &m_txIovecs[i];
+			m_txMsgs[i].msg_iovlen  = 1U;
+
+			struct io_uring_sqe* sqe = ::io_uring_get_sqe(&m_tx);
+			assert(sqe != nullptr);
+
+			::io_uring_prep_sendmsg(sqe, m_fd, &m_txMsgs[i], 0U);
+		}
+
+		int ret = ::io_uring_submit_and_wait(&m_tx, n);
+		if (ret < 0) {
+			LogError("Error returned from io_uring_submit_and_wait, err: %d", -ret);
+			result = false;
+		}
+
+		unsigned int head;
+		unsigned int seen = 0U;
+		struct io_uring_cqe* cqe;
+		io_uring_for_each_cqe(&m_tx, head, cqe) {
+			if (cqe->res < 0 && cqe->res != -ECONNREFUSED) {
+				LogError("Error returned from the io_uring send, err: %d", -cqe->res);
+				result = false;
+			}
+
+			seen++;
+		}
+
+		::io_uring_cq_advance(&m_tx, seen);
+
+		if (ret < 0)
+			return false;
+
+		sent += n;
+	}
+
+	return result;
+}
+
+void CIOURing::close()
+{
+	if (m_bufRing != nullptr) {
+		::io_uring_free_buf_ring(&m_rx, m_bufRing, BUFFER_COUNT, BUFFER_GROUP);
+		m_bufRing = nullptr;
+	}
+
+	if (m_rxOpen) {
+		::io_uring_queue_exit(&m_rx);
+		m_rxOpen = false;
+	}
+
+	if (m_txOpen) {
+		::io_uring_queue_exit(&m_tx);
+		m_txOpen = false;
+	}
+
+	delete[] m_buffers;
+	m_buffers = nullptr;
+
+	m_armed = false;
+	m_fd    = -1;
+}
+
+#endif
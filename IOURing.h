@@ -0,0 +1,68 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(IOURing_H)
+#define	IOURing_H
+
+#if defined(USE_IO_URING) && defined(__linux__)
+
+#include <liburing.h>
+
+#include <sys/socket.h>
+
+// The io_uring side of a CUDPSocket. Receiving uses a single multishot recvmsg
+// drawing on a ring of kernel provided buffers, so no system call is needed
+// per datagram, and the queued datagrams are sent as one submission. Needs
+// Linux 6.0 or later, open() fails on older kernels and the socket carries on
+// using the ordinary system calls.
+class CIOURing {
+public:
+	CIOURing();
+	~CIOURing();
+
+	bool open(int fd);
+
+	// The completion ring's fd, readable whenever datagrams are waiting.
+	int  getFd() const;
+
+	int  read(unsigned char* buffer, unsigned int length, unsigned int count, unsigned int* lengths, sockaddr_storage* addresses, unsigned int* addressLengths = nullptr, unsigned long long* timestamps = nullptr);
+
+	bool write(const unsigned char* buffer, unsigned int slotLength, unsigned int count, const unsigned int* lengths, const sockaddr_storage* addresses, const unsigned int* addressLengths);
+
+	void close();
+
+private:
+	int                 m_fd;
+	struct io_uring     m_rx;
+	struct io_uring     m_tx;
+	bool                m_rxOpen;
+	bool                m_txOpen;
+	io_uring_buf_ring*  m_bufRing;
+	unsigned char*      m_buffers;
+	struct msghdr       m_rxMsg;
+	struct msghdr*      m_txMsgs;
+	struct iovec*       m_txIovecs;
+	bool                m_armed;
+
+	bool arm();
+	unsigned long long getTimestamp(struct io_uring_recvmsg_out* out);
+};
+
+#endif
+
+#endif
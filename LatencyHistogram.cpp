@@ -0,0 +1,95 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LatencyHistogram.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+// The upper bound of each bucket in microseconds, the last one takes everything longer
+const unsigned int BUCKET_LIMITS[LATENCY_BUCKETS - 1U] = {100U, 200U, 500U, 1000U, 2000U, 5000U, 10000U, 20000U, 50000U, 100000U};
+
+CLatencyHistogram::CLatencyHistogram() :
+m_counts(),
+m_count(0U),
+m_total(0ULL),
+m_max(0U)
+{
+	for (unsigned int i = 0U; i < LATENCY_BUCKETS; i++)
+		m_counts[i] = 0U;
+}
+
+void CLatencyHistogram::add(unsigned long long timestamp)
+{
+	if (timestamp == 0ULL)
+		return;
+
+	// The wall clock may have been stepped since the frame arrived
+	unsigned long long now = CLatencyHistogram::now();
+	unsigned int us = (now > timestamp) ? (unsigned int)((now - timestamp) / 1000ULL) : 0U;
+
+	unsigned int bucket = 0U;
+	while (bucket < (LATENCY_BUCKETS - 1U) && us > BUCKET_LIMITS[bucket])
+		bucket++;
+
+	m_counts[bucket]++;
+	m_count++;
+	m_total += us;
+
+	if (us > m_max.load(std::memory_order_relaxed))
+		m_max.store(us, std::memory_order_relaxed);
+}
+
+void CLatencyHistogram::writeJSON(nlohmann::json& json)
+{
+	unsigned int count = m_count;
+
+	json["count"]   = count;
+	json["mean_us"] = (count > 0U) ? (unsigned int)(m_total / count) : 0U;
+	json["max_us"]  = (unsigned int)m_max;
+
+	nlohmann::json limits = nlohmann::json::array();
+	for (unsigned int i = 0U; i < (LATENCY_BUCKETS - 1U); i++)
+		limits.push_back(BUCKET_LIMITS[i]);
+	json["limits_us"] = limits;
+
+	nlohmann::json counts = nlohmann::json::array();
+	for (unsigned int i = 0U; i < LATENCY_BUCKETS; i++)
+		counts.push_back((unsigned int)m_counts[i]);
+	json["counts"] = counts;
+}
+
+unsigned long long CLatencyHistogram::now()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME ft;
+	::GetSystemTimePreciseAsFileTime(&ft);
+
+	// From 100ns units since 1601 to nanoseconds since 1970
+	unsigned long long time = ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+	return (time - 116444736000000000ULL) * 100ULL;
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
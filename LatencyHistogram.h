@@ -0,0 +1,48 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LatencyHistogram_H)
+#define	LatencyHistogram_H
+
+#include <atomic>
+
+#include <nlohmann/json.hpp>
+
+const unsigned int LATENCY_BUCKETS = 11U;
+
+// Counts how long frames spend inside the gateway, from the kernel receiving them to them being
+// handed to the outgoing socket, or how late the main loop wakes up. Timestamps are wall clock
+// nanoseconds, as SO_TIMESTAMPNS gives. One thread may add() while another writes out the counts.
+class CLatencyHistogram {
+public:
+	CLatencyHistogram();
+
+	void add(unsigned long long timestamp);
+
+	void writeJSON(nlohmann::json& json);
+
+	static unsigned long long now();
+
+private:
+	std::atomic<unsigned int>       m_counts[LATENCY_BUCKETS];
+	std::atomic<unsigned int>       m_count;
+	std::atomic<unsigned long long> m_total;
+	std::atomic<unsigned int>       m_max;
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "MMDVMNetwork.h"
 
+#include "HomebrewPacket.h"
 #include "StopWatch.h"
 #include "Utils.h"
 #include "Log.h"
@@ -27,9 +28,15 @@
 #include <cassert>
 
 const unsigned int BUFFER_LENGTH = 500U;
+const unsigned int BATCH_LENGTH  = 16U;
 
-const unsigned int HOMEBREW_DATA_PACKET_LENGTH = 55U;
-const unsigned int HOMEBREW_TRUNKING_DATA_PACKET_LENGTH = 71U; // DMRD with 16 byte UUID extension
+const unsigned int QUEUE_LENGTH  = 64U;
+const unsigned int IDLE_TIMEOUT  = 1000U;
+
+// Enough for a full batch from the socket
+const unsigned int RX_SLOTS = 16U;
+
+const unsigned int PACER_DEPTH = 8U;
 
 
 CMMDVMNetwork::CMMDVMNetwork(const std::string& rptAddress, unsigned short rptPort, const std::string& localAddress, unsigned short localPort, unsigned int id, bool debug, bool trunkingEnabled) :
@@ -38,23 +45,48 @@ m_rptAddrLen(0U),
 m_id(id),
 m_debug(debug),
 m_trunkingEnabled(trunkingEnabled),
+m_connectedSocket(false),
 m_socket(localAddress, localPort),
-m_buffer(nullptr),
-m_rxData(1000U, "MMDVM Network"),
+m_batch(nullptr),
+m_batchLengths(nullptr),
+m_batchAddresses(nullptr),
+m_batchTimestamps(nullptr),
+m_rxReads(0U),
+m_rxPackets(0U),
+m_rxLargestBatch(0U),
+m_txLatency(),
+m_pacers(),
+m_rxData(RX_SLOTS, "MMDVM Network"),
 m_radioPositionData(nullptr),
 m_radioPositionLen(0U),
 m_talkerAliasData(nullptr),
 m_talkerAliasLen(0U),
-m_pingTimer(1000U, 10U)
+m_pingTimer(1000U, 10U),
+m_notify(nullptr),
+m_threadPoller(),
+m_rxQueue(nullptr),
+m_txQueue(nullptr),
+m_radioPositionQueue(nullptr),
+m_talkerAliasQueue(nullptr),
+m_rxStalled(false),
+m_running(false)
 {
 	assert(!rptAddress.empty());
-	assert(rptPort > 0U);
 	assert(id > 0U);
 
-	if (CUDPSocket::lookup(rptAddress, rptPort, m_rptAddr, m_rptAddrLen) != 0)
-		m_rptAddrLen = 0U;
+	// With no port the repeater is on a Unix domain socket, and the addresses are paths
+	if (rptPort == 0U) {
+		if (CUDPSocket::lookupUnix(rptAddress, m_rptAddr, m_rptAddrLen) != 0)
+			m_rptAddrLen = 0U;
+	} else {
+		if (CUDPSocket::lookup(rptAddress, rptPort, m_rptAddr, m_rptAddrLen) != 0)
+			m_rptAddrLen = 0U;
+	}
 
-	m_buffer = new unsigned char[BUFFER_LENGTH];
+	m_batch  = new unsigned char[BATCH_LENGTH * BUFFER_LENGTH];
+	m_batchLengths   = new unsigned int[BATCH_LENGTH];
+	m_batchAddresses = new sockaddr_storage[BATCH_LENGTH];
+	m_batchTimestamps = new unsigned long long[BATCH_LENGTH];
 	m_radioPositionData = new unsigned char[50U];
 	m_talkerAliasData   = new unsigned char[50U];
 
@@ -64,9 +96,62 @@ m_pingTimer(1000U, 10U)
 
 CMMDVMNetwork::~CMMDVMNetwork()
 {
-	delete[] m_buffer;
+	delete[] m_batch;
+	delete[] m_batchLengths;
+	delete[] m_batchAddresses;
+	delete[] m_batchTimestamps;
 	delete[] m_radioPositionData;
 	delete[] m_talkerAliasData;
+
+	delete m_pacers[0U];
+	delete m_pacers[1U];
+
+	delete m_rxQueue;
+	delete m_txQueue;
+	delete m_radioPositionQueue;
+	delete m_talkerAliasQueue;
+}
+
+void CMMDVMNetwork::setPoller(CPoller* poller)
+{
+	m_socket.setPoller(poller);
+}
+
+// As CDMRNetwork::setThreaded(), the radio position and talker alias data get queues of their own
+void CMMDVMNetwork::setThreaded(CPoller* notify)
+{
+	assert(notify != nullptr);
+
+	m_notify = notify;
+
+	m_threadPoller.open();
+	m_socket.setPoller(&m_threadPoller);
+
+	m_rxQueue            = new CSPSCRing<CDMRData>(QUEUE_LENGTH, "rx");
+	m_txQueue            = new CSPSCRing<CNetworkPacket>(QUEUE_LENGTH, "tx");
+	m_radioPositionQueue = new CSPSCRing<CNetworkPacket>(8U, "radio position");
+	m_talkerAliasQueue   = new CSPSCRing<CNetworkPacket>(8U, "talker alias");
+}
+
+// As CDMRNetwork::setConnectedSocket(), for the link to the MMDVM Host
+void CMMDVMNetwork::setConnectedSocket(bool connected)
+{
+	m_connectedSocket = connected;
+}
+
+// Let the network's frames out to the repeater at the rate the slots go over the air
+void CMMDVMNetwork::setPacing(bool pacing)
+{
+	if (!pacing)
+		return;
+
+	m_pacers[0U] = new CFramePacer(1U, PACER_DEPTH);
+	m_pacers[1U] = new CFramePacer(2U, PACER_DEPTH);
+}
+
+void CMMDVMNetwork::setRxOverflow(RING_OVERFLOW overflow)
+{
+	m_rxData.setOverflow(overflow);
 }
 
 bool CMMDVMNetwork::open()
@@ -78,85 +163,109 @@ bool CMMDVMNetwork::open()
 
 	LogMessage("MMDVM Network, Opening");
 
+	bool ret = m_socket.open(m_rptAddr);
+	if (!ret)
+		return false;
+
+	if (m_connectedSocket && !m_socket.connect(m_rptAddr, m_rptAddrLen))
+		LogWarning("MMDVM Network, Could not connect the socket to the MMDVM Host, checking the source of each packet instead");
+
+	// The ping timer belongs to the network's own thread, so it starts it itself
+	if (m_rxQueue != nullptr) {
+		m_running = true;
+		return run();
+	}
+
 	m_pingTimer.start();
 
-	return m_socket.open(m_rptAddr);
+	return true;
 }
 
 bool CMMDVMNetwork::read(CDMRData& data)
 {
-	if (m_rxData.isEmpty())
-		return false;
+	if (m_rxQueue == nullptr)
+		return decode(data);
 
-	unsigned char length = 0U;
+	bool ret = m_rxQueue->pop(data);
+	if (ret)
+		resumeRx();
 
-	m_rxData.getData(&length, 1U);
-	m_rxData.getData(m_buffer, length);
+	return ret;
+}
 
-	if ((::memcmp(m_buffer, "DMRT", 4U) == 0) && m_trunkingEnabled) { // DMRT protocol message
-		if(data.setMessage(m_buffer, length)) {
-			return true;
-		}
+bool CMMDVMNetwork::decode(CDMRData& data)
+{
+	unsigned int length = 0U;
+	unsigned long long timestamp = 0ULL;
+	const unsigned char* packet = m_rxData.peek(length, timestamp);
+	if (packet == nullptr)
 		return false;
-	}
 
-	// Is this a data packet?
-	if (::memcmp(m_buffer, "DMRD", 4U) != 0)
-		return false;
+	data.setTimestamp(timestamp);
 
-	unsigned char seqNo = m_buffer[4U];
+	bool ret = false;
+	HOMEBREW_PACKET type = CHomebrewPacket::classify(packet, length);
 
-	unsigned int srcId = (m_buffer[5U] << 16) | (m_buffer[6U] << 8) | (m_buffer[7U] << 0);
+	if ((type == HOMEBREW_PACKET::DMRT) && m_trunkingEnabled) { // DMRT protocol message
+		ret = data.setMessage(packet, length);
+	} else if (type == HOMEBREW_PACKET::DMRD) {
+		// The ring buffer only holds DMRD frames of the two valid lengths, they are left as they arrived
+		unsigned char* buffer = data.getPacket();
+		::memcpy(buffer, packet, length);
 
-	unsigned int dstId = (m_buffer[8U] << 16) | (m_buffer[9U] << 8) | (m_buffer[10U] << 0);
+		if ((length != HOMEBREW_TRUNKING_DATA_PACKET_LENGTH) || !m_trunkingEnabled)
+			::memset(buffer + HOMEBREW_DATA_PACKET_LENGTH, 0x00U, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH - HOMEBREW_DATA_PACKET_LENGTH);
 
-	unsigned int slotNo = (m_buffer[15U] & 0x80U) == 0x80U ? 2U : 1U;
+		ret = true;
+	}
 
-	FLCO flco = (m_buffer[15U] & 0x40U) == 0x40U ? FLCO::USER_USER : FLCO::GROUP;
+	m_rxData.pop();
 
-	unsigned int streamId;
-	::memcpy(&streamId, m_buffer + 16U, 4U);
+	return ret;
+}
 
-	unsigned char ber = m_buffer[53U];
+// When blocking, only take as many datagrams as the ring buffer can hold, the rest wait in the socket
+unsigned int CMMDVMNetwork::getRxSpace() const
+{
+	if ((m_rxData.getOverflow() == RING_OVERFLOW::BLOCK) && (m_rxData.freeSlots() < BATCH_LENGTH))
+		return m_rxData.freeSlots();
 
-	unsigned char rssi = m_buffer[54U];
+	return BATCH_LENGTH;
+}
 
-	data.setSeqNo(seqNo);
-	data.setSlotNo(slotNo);
-	data.setSrcId(srcId);
-	data.setDstId(dstId);
-	data.setFLCO(flco);
-	data.setStreamId(streamId);
-	data.setBER(ber);
-	data.setRSSI(rssi);
+// The network's thread leaves frames in the ring while the receive queue is full, so that the
+// overflow policy applies to them there. It is woken by resumeRx() once the routing thread has taken
+// a frame, and the fences make sure that one of the two threads always sees what the other did.
+bool CMMDVMNetwork::isRxQueueFull()
+{
+	if (m_rxQueue->space() > 0U)
+		return false;
 
-	bool dataSync = (m_buffer[15U] & 0x20U) == 0x20U;
-	bool voiceSync = (m_buffer[15U] & 0x10U) == 0x10U;
+	m_rxStalled.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 
-	if (dataSync) {
-		unsigned char dataType = m_buffer[15U] & 0x0FU;
-		data.setData(m_buffer + 20U);
-		data.setDataType(dataType);
-		data.setN(0U);
-	} else if (voiceSync) {
-		data.setData(m_buffer + 20U);
-		data.setDataType(DT_VOICE_SYNC);
-		data.setN(0U);
-	} else {
-		unsigned char n = m_buffer[15U] & 0x0FU;
-		data.setData(m_buffer + 20U);
-		data.setDataType(DT_VOICE);
-		data.setN(n);
-	}
+	if (m_rxQueue->space() == 0U)
+		return true;
 
-	if((length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH) && m_trunkingEnabled) {
-		unsigned char uuid[16];
-		::memset(uuid, 0, 16U);
-		::memcpy(uuid, m_buffer + 55U, 16U);
-		data.setUUID(uuid);
-	}
+	m_rxStalled.store(false, std::memory_order_relaxed);
 
-	return true;
+	return false;
+}
+
+void CMMDVMNetwork::resumeRx()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_rxStalled.load(std::memory_order_relaxed) && m_rxStalled.exchange(false))
+		m_threadPoller.wake();
+}
+
+bool CMMDVMNetwork::hasData() const
+{
+	if (m_rxQueue != nullptr)
+		return !m_rxQueue->isEmpty();
+
+	return !m_rxData.isEmpty();
 }
 
 bool CMMDVMNetwork::write(const CDMRData& data)
@@ -171,76 +280,38 @@ bool CMMDVMNetwork::write(const CDMRData& data)
 		if (m_debug)
 			CUtils::dump(1U, "Network Transmitted", buffer, length);
 
-		m_socket.write(buffer, length, m_rptAddr, m_rptAddrLen);
+		send(buffer, length, data.getTimestamp());
 		return true;
 	}
 	const unsigned int buffer_size = m_trunkingEnabled ? HOMEBREW_TRUNKING_DATA_PACKET_LENGTH : HOMEBREW_DATA_PACKET_LENGTH;
+	// The frame goes out as it is apart from our own ID, a copy is only needed as the same frame may
+	// be written to more than one network
 	unsigned char buffer[HOMEBREW_TRUNKING_DATA_PACKET_LENGTH];
-	::memset(buffer, 0x00U, HOMEBREW_TRUNKING_DATA_PACKET_LENGTH);
-
-	buffer[0U]  = 'D';
-	buffer[1U]  = 'M';
-	buffer[2U]  = 'R';
-	buffer[3U]  = 'D';
-
-	unsigned int srcId = data.getSrcId();
-	buffer[5U]  = srcId >> 16;
-	buffer[6U]  = srcId >> 8;
-	buffer[7U]  = srcId >> 0;
-
-	unsigned int dstId = data.getDstId();
-	buffer[8U]  = dstId >> 16;
-	buffer[9U]  = dstId >> 8;
-	buffer[10U] = dstId >> 0;
-
-	buffer[11U] = m_id >> 24;
-	buffer[12U] = m_id >> 16;
-	buffer[13U] = m_id >> 8;
-	buffer[14U] = m_id >> 0;
+	::memcpy(buffer, data.getPacket(), buffer_size);
 
-	unsigned int slotNo = data.getSlotNo();
-
-	buffer[15U] = slotNo == 1U ? 0x00U : 0x80U;
-
-	FLCO flco = data.getFLCO();
-	buffer[15U] |= flco == FLCO::GROUP ? 0x00U : 0x40U;
-
-	unsigned char dataType = data.getDataType();
-	if (dataType == DT_VOICE_SYNC) {
-		buffer[15U] |= 0x10U;
-	} else if (dataType == DT_VOICE) {
-		buffer[15U] |= data.getN();
-	} else {
-		buffer[15U] |= (0x20U | dataType);
-	}
-
-	buffer[4U] = data.getSeqNo();
-
-	unsigned int streamId = data.getStreamId();
-	::memcpy(buffer + 16U, &streamId, 4U);
-
-	data.getData(buffer + 20U);
-
-	buffer[53U] = data.getBER();
-
-	buffer[54U] = data.getRSSI();
-
-	if(m_trunkingEnabled) {
-		unsigned char uuid[16U];
-		data.getUUID(uuid);
-		::memcpy(buffer + 55U, uuid, 16U);
-	}
+	CDMRPacket(buffer).setRptId(m_id);
 
 	if (m_debug)
 		CUtils::dump(1U, "Network Transmitted", buffer, buffer_size);
 
-	m_socket.write(buffer, buffer_size, m_rptAddr, m_rptAddrLen);
+	send(buffer, buffer_size, data.getTimestamp());
 
 	return true;
 }
 
 bool CMMDVMNetwork::readRadioPosition(unsigned char* data, unsigned int& length)
 {
+	if (m_radioPositionQueue != nullptr) {
+		CNetworkPacket packet;
+		if (!m_radioPositionQueue->pop(packet))
+			return false;
+
+		::memcpy(data, packet.m_data, packet.m_length);
+		length = packet.m_length;
+
+		return true;
+	}
+
 	if (m_radioPositionLen == 0U)
 		return false;
 
@@ -254,6 +325,17 @@ bool CMMDVMNetwork::readRadioPosition(unsigned char* data, unsigned int& length)
 
 bool CMMDVMNetwork::readTalkerAlias(unsigned char* data, unsigned int& length)
 {
+	if (m_talkerAliasQueue != nullptr) {
+		CNetworkPacket packet;
+		if (!m_talkerAliasQueue->pop(packet))
+			return false;
+
+		::memcpy(data, packet.m_data, packet.m_length);
+		length = packet.m_length;
+
+		return true;
+	}
+
 	if (m_talkerAliasLen == 0U)
 		return false;
 
@@ -267,13 +349,97 @@ bool CMMDVMNetwork::readTalkerAlias(unsigned char* data, unsigned int& length)
 
 bool CMMDVMNetwork::writeBeacon()
 {
-	return m_socket.write((unsigned char*)"DMRB", 4U, m_rptAddr, m_rptAddrLen);
+	return send((unsigned char*)"DMRB", 4U);
+}
+
+// Frames from the routing thread go via the network's own thread when it has one
+bool CMMDVMNetwork::send(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+
+	if (m_txQueue == nullptr)
+		return transmit(data, length, timestamp);
+
+	if (length > NETWORK_PACKET_LENGTH)
+		return false;
+
+	CNetworkPacket packet;
+	::memcpy(packet.m_data, data, length);
+	packet.m_length    = length;
+	packet.m_timestamp = timestamp;
+
+	bool ret = m_txQueue->push(packet);
+	if (!ret) {
+		LogWarning("MMDVM Network, Transmit queue is full, dropping a frame");
+		return false;
+	}
+
+	m_threadPoller.wake();
+
+	return true;
+}
+
+bool CMMDVMNetwork::transmit(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+
+	bool paced = (m_pacers[0U] != nullptr) && (CHomebrewPacket::classify(data, length) == HOMEBREW_PACKET::DMRD) &&
+		((length == HOMEBREW_DATA_PACKET_LENGTH) || (length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH));
+	if (paced) {
+		unsigned int slotNo = (data[15U] & 0x80U) == 0x80U ? 2U : 1U;
+		m_pacers[slotNo - 1U]->add(data, length, timestamp);
+		releasePaced();
+		return true;
+	}
+
+	bool ret = m_socket.queue(data, length, m_rptAddr, m_rptAddrLen);
+	m_txLatency.add(timestamp);
+
+	return ret;
+}
+
+void CMMDVMNetwork::releasePaced()
+{
+	if (m_pacers[0U] == nullptr)
+		return;
+
+	unsigned char data[HOMEBREW_TRUNKING_DATA_PACKET_LENGTH];
+	unsigned int length = 0U;
+	unsigned long long timestamp = 0ULL;
+
+	for (unsigned int i = 0U; i < 2U; i++) {
+		while (m_pacers[i]->get(data, length, timestamp)) {
+			m_socket.queue(data, length, m_rptAddr, m_rptAddrLen);
+			m_txLatency.add(timestamp);
+		}
+	}
+}
+
+void CMMDVMNetwork::flush()
+{
+	m_socket.flush();
 }
 
 void CMMDVMNetwork::close()
 {
+	// Let the network's thread shut down the socket itself
+	if (m_running) {
+		m_running = false;
+		m_threadPoller.wake();
+		wait();
+		return;
+	}
+
 	LogMessage("MMDVM Network, Closing");
 
+	// Their timers belong to the thread closing the network
+	if (m_pacers[0U] != nullptr) {
+		m_pacers[0U]->reset();
+		m_pacers[1U]->reset();
+	}
+
 	m_socket.close();
 }
 
@@ -285,48 +451,185 @@ void CMMDVMNetwork::clock(unsigned int ms)
 		m_pingTimer.start();
 	}
 
-	sockaddr_storage address;
-	unsigned int addrlen;
-	int length = m_socket.read(m_buffer, BUFFER_LENGTH, address, addrlen);
-	if (length <= 0)
+	releasePaced();
+
+	unsigned int space = getRxSpace();
+
+	if (space == 0U)
 		return;
 
-	if (!CUDPSocket::match(m_rptAddr, address)) {
+	int count = m_socket.read(m_batch, BUFFER_LENGTH, space, m_batchLengths, m_batchAddresses, m_batchTimestamps);
+	if (count < 0) {
+		// A failed socket is opened again by CUDPSocket, which leaves it no longer connected
+		if (m_connectedSocket && !m_socket.isConnected() && !m_socket.connect(m_rptAddr, m_rptAddrLen))
+			LogWarning("MMDVM Network, Could not connect the socket to the MMDVM Host, checking the source of each packet instead");
+		return;
+	}
+
+	if (count == 0)
+		return;
+
+	m_rxReads++;
+	m_rxPackets += count;
+	if ((unsigned int)count > m_rxLargestBatch)
+		m_rxLargestBatch = count;
+
+	for (int i = 0; i < count; i++)
+		processPacket(m_batch + i * BUFFER_LENGTH, m_batchLengths[i], m_batchAddresses[i], m_batchTimestamps[i]);
+}
+
+void CMMDVMNetwork::writeStats(nlohmann::json& json)
+{
+	json["name"]             = "MMDVM";
+	json["rx_reads"]         = m_rxReads.load();
+	json["rx_packets"]       = m_rxPackets.load();
+	json["rx_largest_batch"] = m_rxLargestBatch.exchange(0U);
+
+	m_txLatency.writeJSON(json["tx_latency"]);
+
+	if (m_rxQueue != nullptr) {
+		json["rx_queue_depth"]     = m_rxQueue->depth();
+		json["rx_queue_max_depth"] = m_rxQueue->getMaxDepth();
+		json["rx_queue_dropped"]   = m_rxQueue->getDropped();
+		json["tx_queue_depth"]     = m_txQueue->depth();
+		json["tx_queue_max_depth"] = m_txQueue->getMaxDepth();
+		json["tx_queue_dropped"]   = m_txQueue->getDropped();
+	}
+
+	json["rx_ring_slots"]     = m_rxData.getSlots();
+	json["rx_ring_depth"]     = m_rxData.depth();
+	json["rx_ring_max_depth"] = m_rxData.getMaxDepth();
+	json["rx_ring_overflows"] = m_rxData.getOverflows();
+
+	if (m_pacers[0U] != nullptr) {
+		nlohmann::json pacing = nlohmann::json::array();
+		for (unsigned int i = 0U; i < 2U; i++) {
+			nlohmann::json slot;
+			m_pacers[i]->writeStats(slot);
+			pacing.push_back(slot);
+		}
+		json["tx_pacing"] = pacing;
+	}
+}
+
+void CMMDVMNetwork::writeLatency(nlohmann::json& json)
+{
+	m_txLatency.writeJSON(json);
+}
+
+void CMMDVMNetwork::processPacket(const unsigned char* packet, unsigned int length, const sockaddr_storage& address, unsigned long long timestamp)
+{
+	assert(packet != nullptr);
+
+	if (length == 0U)
+		return;
+
+	if (!m_socket.isConnected() && !CUDPSocket::match(m_rptAddr, address)) {
 		LogMessage("MMDVM packet received from an invalid source");
 		return;
 	}
 
 	if (m_debug)
-		CUtils::dump(1U, "Network Received", m_buffer, length);
+		CUtils::dump(1U, "Network Received", packet, length);
 
-	if ((::memcmp(m_buffer, "DMRT", 4U) == 0) && (length <= 255) && m_trunkingEnabled) {
-		unsigned char len = length;
-		m_rxData.addData(&len, 1U);
-		m_rxData.addData(m_buffer, len);
-	} else if (::memcmp(m_buffer, "DMRD", 4U) == 0) {
+	HOMEBREW_PACKET type = CHomebrewPacket::classify(packet, length);
+
+	if ((type == HOMEBREW_PACKET::DMRT) && (length <= 255U) && m_trunkingEnabled) {
+		addRxData(packet, length, timestamp);
+	} else if (type == HOMEBREW_PACKET::DMRD) {
 		if ((length == HOMEBREW_DATA_PACKET_LENGTH) || (length == HOMEBREW_TRUNKING_DATA_PACKET_LENGTH)) {
-			unsigned char len = length;
-			m_rxData.addData(&len, 1U);
-			m_rxData.addData(m_buffer, len);
+			addRxData(packet, length, timestamp);
 		}
-	} else if (::memcmp(m_buffer, "DMRG", 4U) == 0) {
-		if (length <= 50) {
-			::memcpy(m_radioPositionData, m_buffer, length);
+	} else if (type == HOMEBREW_PACKET::DMRG) {
+		if (length <= 50U) {
+			::memcpy(m_radioPositionData, packet, length);
 			m_radioPositionLen = length;
 		}
-	} else if (::memcmp(m_buffer, "DMRA", 4U) == 0) {
-		if (length <= 50) {
-			::memcpy(m_talkerAliasData, m_buffer, length);
+	} else if (type == HOMEBREW_PACKET::DMRA) {
+		if (length <= 50U) {
+			::memcpy(m_talkerAliasData, packet, length);
 			m_talkerAliasLen = length;
 		}
-	} else if (::memcmp(m_buffer, "DMRP", 4U) == 0) {
+	} else if (type == HOMEBREW_PACKET::DMRP) {
 		;
 	} else {
-		CUtils::dump("Unknown packet from the MMDVM", m_buffer, length);
+		CUtils::dump("Unknown packet from the MMDVM", packet, length);
 	}
 }
 
+void CMMDVMNetwork::addRxData(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+
+	// Without a kernel timestamp, this is the closest there is to the arrival time
+	if (timestamp == 0ULL)
+		timestamp = CLatencyHistogram::now();
+
+	m_rxData.add(data, length, timestamp);
+}
+
 bool CMMDVMNetwork::writePing()
 {
-	return m_socket.write((unsigned char*)"DMRP", 4U, m_rptAddr, m_rptAddrLen);
+	return m_socket.queue((unsigned char*)"DMRP", 4U, m_rptAddr, m_rptAddrLen);
+}
+
+void CMMDVMNetwork::entry()
+{
+	m_pingTimer.start();
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	while (m_running) {
+		m_threadPoller.wait(CTimerService::getNextExpiry(IDLE_TIMEOUT));
+
+		CTimerService::clock();
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		CNetworkPacket packet;
+		while (m_txQueue->pop(packet))
+			transmit(packet.m_data, packet.m_length, packet.m_timestamp);
+
+		clock(ms);
+
+		bool received = false;
+		while (!m_rxData.isEmpty() && !isRxQueueFull()) {
+			CDMRData data;
+			if (decode(data)) {
+				m_rxQueue->push(data);
+				received = true;
+			}
+		}
+
+		// With the ring full the socket stays readable, so it is left out of the poll until there is
+		// room again, and until then this thread sleeps until resumeRx() wakes it
+		m_socket.setPolling(getRxSpace() > 0U);
+
+		if (m_radioPositionLen > 0U) {
+			::memcpy(packet.m_data, m_radioPositionData, m_radioPositionLen);
+			packet.m_length = m_radioPositionLen;
+			m_radioPositionQueue->push(packet);
+			m_radioPositionLen = 0U;
+			received = true;
+		}
+
+		if (m_talkerAliasLen > 0U) {
+			::memcpy(packet.m_data, m_talkerAliasData, m_talkerAliasLen);
+			packet.m_length = m_talkerAliasLen;
+			m_talkerAliasQueue->push(packet);
+			m_talkerAliasLen = 0U;
+			received = true;
+		}
+
+		if (received)
+			m_notify->wake();
+
+		flush();
+	}
+
+	m_pingTimer.stop();
+
+	close();
 }
@@ -19,24 +19,45 @@
 #if !defined(MMDVMNetwork_H)
 #define	MMDVMNetwork_H
 
+#include "LatencyHistogram.h"
+#include "FramePacer.h"
+#include "NetworkPacket.h"
 #include "UDPSocket.h"
-#include "Timer.h"
-#include "RingBuffer.h"
+#include "PacketRing.h"
+#include "SPSCRing.h"
 #include "DMRData.h"
+#include "Poller.h"
+#include "Thread.h"
+#include "Timer.h"
 
 #include <string>
+#include <atomic>
 #include <cstdint>
 
-class CMMDVMNetwork
+#include <nlohmann/json.hpp>
+
+class CMMDVMNetwork : public CThread
 {
 public:
 	CMMDVMNetwork(const std::string& rptAddress, unsigned short rptPort, const std::string& localAddress, unsigned short localPort, unsigned int id, bool debug, bool trunkingEnabled);
 	~CMMDVMNetwork();
 
+	void setPoller(CPoller* poller);
+
+	void setThreaded(CPoller* notify);
+
+	void setConnectedSocket(bool connected);
+
+	void setPacing(bool pacing);
+
+	void setRxOverflow(RING_OVERFLOW overflow);
+
 	bool open();
 
 	bool read(CDMRData& data);
 
+	bool hasData() const;
+
 	bool write(const CDMRData& data);
 
 	bool readRadioPosition(unsigned char* data, unsigned int& length);
@@ -45,26 +66,61 @@ public:
 
 	bool writeBeacon();
 
+	void flush();
+
 	void clock(unsigned int ms);
 
+	void writeStats(nlohmann::json& json);
+	void writeLatency(nlohmann::json& json);
+
 	void close();
 
+	virtual void entry();
+
 private: 
 	sockaddr_storage           m_rptAddr;
 	unsigned int               m_rptAddrLen;
 	unsigned int               m_id;
 	bool                       m_debug;
 	bool                       m_trunkingEnabled;
+	bool                       m_connectedSocket;
 	CUDPSocket                 m_socket;
-	unsigned char*             m_buffer;
-	CRingBuffer<unsigned char> m_rxData;
+	unsigned char*             m_batch;
+	unsigned int*              m_batchLengths;
+	sockaddr_storage*          m_batchAddresses;
+	unsigned long long*        m_batchTimestamps;
+	std::atomic<unsigned int>  m_rxReads;
+	std::atomic<unsigned int>  m_rxPackets;
+	std::atomic<unsigned int>  m_rxLargestBatch;
+	CLatencyHistogram          m_txLatency;
+	CFramePacer*               m_pacers[2U];
+	CPacketRing                m_rxData;
 	unsigned char*             m_radioPositionData;
 	unsigned int               m_radioPositionLen;
 	unsigned char*             m_talkerAliasData;
 	unsigned int               m_talkerAliasLen;
 	CTimer                     m_pingTimer;
+	CPoller*                   m_notify;
+	CPoller                    m_threadPoller;
+	CSPSCRing<CDMRData>*       m_rxQueue;
+	CSPSCRing<CNetworkPacket>* m_txQueue;
+	CSPSCRing<CNetworkPacket>* m_radioPositionQueue;
+	CSPSCRing<CNetworkPacket>* m_talkerAliasQueue;
+	std::atomic<bool>          m_rxStalled;
+	std::atomic<bool>          m_running;
 
 	bool writePing();
+
+	void processPacket(const unsigned char* packet, unsigned int length, const sockaddr_storage& address, unsigned long long timestamp);
+	void addRxData(const unsigned char* data, unsigned int length, unsigned long long timestamp);
+
+	bool decode(CDMRData& data);
+	unsigned int getRxSpace() const;
+	bool isRxQueueFull();
+	void resumeRx();
+	bool send(const unsigned char* data, unsigned int length, unsigned long long timestamp = 0ULL);
+	bool transmit(const unsigned char* data, unsigned int length, unsigned long long timestamp);
+	void releasePaced();
 };
 
 #endif
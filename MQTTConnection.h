@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
 
 enum class MQTT_QOS : int {
 	AT_MODE_ONCE  = 0,
@@ -54,7 +55,7 @@ private:
 	unsigned int   m_keepalive;
 	MQTT_QOS       m_qos;
 	mosquitto*     m_mosq;
-	bool           m_connected;
+	std::atomic<bool> m_connected;
 
 	static void onConnect(mosquitto* mosq, void* obj, int rc);
 	static void onSubscribe(mosquitto* mosq, void* obj, int mid, int qosCount, const int* grantedQOS);
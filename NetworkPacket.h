@@ -0,0 +1,31 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(NetworkPacket_H)
+#define	NetworkPacket_H
+
+const unsigned int NETWORK_PACKET_LENGTH = 256U;
+
+// An encoded datagram in transit between the routing thread and a network's own thread
+struct CNetworkPacket {
+	unsigned char      m_data[NETWORK_PACKET_LENGTH];
+	unsigned int       m_length;
+	unsigned long long m_timestamp;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "PacketRing.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+CPacketRing::CPacketRing(unsigned int slots, const char* name) :
+m_slots(slots),
+m_name(name),
+m_overflow(RING_OVERFLOW::BLOCK),
+m_overflowing(false),
+m_buffer(nullptr),
+m_iPtr(0U),
+m_oPtr(0U),
+m_depth(0U),
+m_maxDepth(0U),
+m_overflows(0U)
+{
+	assert(slots > 0U);
+	assert(name != nullptr);
+
+	m_buffer = new CPacketSlot[slots];
+}
+
+CPacketRing::~CPacketRing()
+{
+	delete[] m_buffer;
+}
+
+void CPacketRing::setOverflow(RING_OVERFLOW overflow)
+{
+	m_overflow = overflow;
+}
+
+RING_OVERFLOW CPacketRing::getOverflow() const
+{
+	return m_overflow;
+}
+
+bool CPacketRing::add(const unsigned char* data, unsigned int length, unsigned long long timestamp)
+{
+	assert(data != nullptr);
+	assert(length <= PACKET_SLOT_LENGTH);
+
+	unsigned int depth = m_depth.load(std::memory_order_relaxed);
+	if (depth == m_slots) {
+		m_overflows++;
+
+		// Only the first packet lost in a run is logged, a burst would otherwise log every one of them
+		if (!m_overflowing) {
+			LogWarning("%s buffer overflow, %s", m_name, (m_overflow == RING_OVERFLOW::DROP_OLDEST) ? "dropping the oldest packets" : "dropping new packets");
+			m_overflowing = true;
+		}
+
+		if (m_overflow != RING_OVERFLOW::DROP_OLDEST)
+			return false;
+
+		m_oPtr++;
+		if (m_oPtr == m_slots)
+			m_oPtr = 0U;
+
+		depth--;
+	} else {
+		m_overflowing = false;
+	}
+
+	CPacketSlot& slot = m_buffer[m_iPtr];
+	slot.m_timestamp = timestamp;
+	slot.m_length    = length;
+	::memcpy(slot.m_data, data, length);
+
+	m_iPtr++;
+	if (m_iPtr == m_slots)
+		m_iPtr = 0U;
+
+	depth++;
+	m_depth.store(depth, std::memory_order_relaxed);
+
+	if (depth > m_maxDepth.load(std::memory_order_relaxed))
+		m_maxDepth.store(depth, std::memory_order_relaxed);
+
+	return true;
+}
+
+const unsigned char* CPacketRing::peek(unsigned int& length, unsigned long long& timestamp) const
+{
+	if (isEmpty())
+		return nullptr;
+
+	const CPacketSlot& slot = m_buffer[m_oPtr];
+	length    = slot.m_length;
+	timestamp = slot.m_timestamp;
+
+	return slot.m_data;
+}
+
+void CPacketRing::pop()
+{
+	if (isEmpty())
+		return;
+
+	m_oPtr++;
+	if (m_oPtr == m_slots)
+		m_oPtr = 0U;
+
+	m_depth.store(m_depth.load(std::memory_order_relaxed) - 1U, std::memory_order_relaxed);
+}
+
+void CPacketRing::clear()
+{
+	m_iPtr = 0U;
+	m_oPtr = 0U;
+
+	m_depth.store(0U, std::memory_order_relaxed);
+}
+
+bool CPacketRing::isEmpty() const
+{
+	return m_depth.load(std::memory_order_relaxed) == 0U;
+}
+
+bool CPacketRing::isFull() const
+{
+	return m_depth.load(std::memory_order_relaxed) == m_slots;
+}
+
+unsigned int CPacketRing::freeSlots() const
+{
+	return m_slots - m_depth.load(std::memory_order_relaxed);
+}
+
+unsigned int CPacketRing::depth() const
+{
+	return m_depth.load(std::memory_order_relaxed);
+}
+
+unsigned int CPacketRing::getSlots() const
+{
+	return m_slots;
+}
+
+unsigned int CPacketRing::getMaxDepth()
+{
+	return m_maxDepth.exchange(0U);
+}
+
+unsigned int CPacketRing::getOverflows() const
+{
+	return m_overflows.load();
+}
@@ -0,0 +1,91 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(PacketRing_H)
+#define	PacketRing_H
+
+#include <atomic>
+
+// Big enough for the longest packet that is queued, a DMRT message
+const unsigned int PACKET_SLOT_LENGTH = 255U;
+
+// What happens to a packet that arrives when the ring is full. Dropping the oldest keeps the delay
+// through the ring bounded, dropping the newest keeps what is already queued intact, and blocking
+// leaves the reader to stop taking packets from the socket until there is room, so the excess
+// waits in the socket's own buffer.
+enum class RING_OVERFLOW {
+	DROP_OLDEST,
+	DROP_NEWEST,
+	BLOCK
+};
+
+// A ring of whole received packets, each in a fixed size slot along with its length and receive
+// timestamp. A packet is copied in once and can be looked at where it is before being let go, so
+// there is no length prefix to unpick on the way out. Only one thread may use it, apart from
+// reading the depth and the counts for the statistics.
+class CPacketRing {
+public:
+	CPacketRing(unsigned int slots, const char* name);
+	~CPacketRing();
+
+	void setOverflow(RING_OVERFLOW overflow);
+	RING_OVERFLOW getOverflow() const;
+
+	// Returns false if the ring was full and the packet was dropped
+	bool add(const unsigned char* data, unsigned int length, unsigned long long timestamp);
+
+	// The oldest packet, which stays in the ring until pop() is called, or nullptr if it is empty
+	const unsigned char* peek(unsigned int& length, unsigned long long& timestamp) const;
+
+	void pop();
+
+	void clear();
+
+	bool isEmpty() const;
+	bool isFull() const;
+
+	unsigned int freeSlots() const;
+	unsigned int depth() const;
+	unsigned int getSlots() const;
+
+	// The deepest the ring has been since the last call
+	unsigned int getMaxDepth();
+
+	// The number of packets lost because the ring was full
+	unsigned int getOverflows() const;
+
+private:
+	struct CPacketSlot {
+		unsigned long long m_timestamp;
+		unsigned int       m_length;
+		unsigned char      m_data[PACKET_SLOT_LENGTH];
+	};
+
+	unsigned int              m_slots;
+	const char*               m_name;
+	RING_OVERFLOW             m_overflow;
+	bool                      m_overflowing;
+	CPacketSlot*              m_buffer;
+	unsigned int              m_iPtr;
+	unsigned int              m_oPtr;
+	std::atomic<unsigned int> m_depth;
+	std::atomic<unsigned int> m_maxDepth;
+	std::atomic<unsigned int> m_overflows;
+};
+
+#endif
@@ -48,3 +48,8 @@ PROCESS_RESULT CPassAllPC::process(CDMRData& data, bool trace)
 
 	return ret ? PROCESS_RESULT::MATCHED : PROCESS_RESULT::UNMATCHED;
 }
+
+void CPassAllPC::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::PRIVATE));
+}
@@ -48,3 +48,8 @@ PROCESS_RESULT CPassAllTG::process(CDMRData& data, bool trace)
 
 	return ret ? PROCESS_RESULT::MATCHED : PROCESS_RESULT::UNMATCHED;
 }
+
+void CPassAllTG::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::GROUP));
+}
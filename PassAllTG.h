@@ -30,6 +30,7 @@ public:
 	virtual ~CPassAllTG();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 private:
 	std::string  m_name;
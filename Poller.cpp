@@ -0,0 +1,247 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Poller.h"
+#include "Thread.h"
+#include "Log.h"
+
+#include <cassert>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+
+const unsigned int MAX_EVENTS = 16U;
+#elif !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+// How long each pass sleeps for when there is nothing to poll
+const unsigned int FALLBACK_SLEEP = 10U;
+
+CPoller::CPoller() :
+#if defined(__linux__)
+m_fd(-1),
+m_wakeFd(-1)
+#else
+m_fds()
+#endif
+{
+#if !defined(__linux__) && !defined(_WIN32) && !defined(_WIN64)
+	m_wakeFds[0U] = -1;
+	m_wakeFds[1U] = -1;
+#endif
+}
+
+CPoller::~CPoller()
+{
+	close();
+}
+
+bool CPoller::open()
+{
+#if defined(__linux__)
+	assert(m_fd == -1);
+
+	m_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (m_fd == -1) {
+		LogError("Cannot create the epoll instance, err: %d", errno);
+		return false;
+	}
+
+	// Without a way to wake it, the other threads can't hand anything to this one, so give up on
+	// polling altogether
+	m_wakeFd = ::eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_wakeFd == -1) {
+		LogError("Cannot create the poller wake up event, err: %d", errno);
+		close();
+		return false;
+	}
+
+	add(m_wakeFd);
+#elif !defined(_WIN32) && !defined(_WIN64)
+	if (::pipe(m_wakeFds) == -1) {
+		LogError("Cannot create the poller wake up pipe, err: %d", errno);
+		return false;
+	}
+
+	::fcntl(m_wakeFds[0U], F_SETFL, O_NONBLOCK);
+	::fcntl(m_wakeFds[1U], F_SETFL, O_NONBLOCK);
+
+	add(m_wakeFds[0U]);
+#endif
+
+	return true;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+void CPoller::add(SOCKET fd)
+#else
+void CPoller::add(int fd)
+#endif
+{
+#if defined(__linux__)
+	if (m_fd == -1)
+		return;
+
+	struct epoll_event event;
+	event.events  = EPOLLIN;
+	event.data.fd = fd;
+
+	if (::epoll_ctl(m_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+		LogError("Cannot add a socket to the epoll instance, err: %d", errno);
+#else
+	pollfd pfd;
+	pfd.fd      = fd;
+	pfd.events  = POLLIN;
+	pfd.revents = 0;
+
+	m_fds.push_back(pfd);
+#endif
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+void CPoller::remove(SOCKET fd)
+#else
+void CPoller::remove(int fd)
+#endif
+{
+#if defined(__linux__)
+	if (m_fd == -1)
+		return;
+
+	// Closing the socket removes it from the epoll set anyway, this just keeps it tidy
+	::epoll_ctl(m_fd, EPOLL_CTL_DEL, fd, nullptr);
+#else
+	for (std::vector<pollfd>::iterator it = m_fds.begin(); it != m_fds.end(); ++it) {
+		if ((*it).fd == fd) {
+			m_fds.erase(it);
+			return;
+		}
+	}
+#endif
+}
+
+int CPoller::wait(unsigned int ms)
+{
+#if defined(__linux__)
+	if (m_fd == -1) {
+		CThread::sleep((ms < FALLBACK_SLEEP) ? ms : FALLBACK_SLEEP);
+		return 0;
+	}
+
+	// Level triggered, anything left unread will wake us again straight away
+	struct epoll_event events[MAX_EVENTS];
+	int ret = ::epoll_wait(m_fd, events, MAX_EVENTS, int(ms));
+	if (ret == -1) {
+		if (errno == EINTR)
+			return 0;
+
+		LogError("Error returned from epoll_wait, err: %d", errno);
+		CThread::sleep(ms);
+		return -1;
+	}
+
+	for (int i = 0; i < ret; i++) {
+		if (events[i].data.fd == m_wakeFd) {
+			uint64_t count;
+			ssize_t n = ::read(m_wakeFd, &count, sizeof(uint64_t));
+			(void)n;
+		}
+	}
+
+	return ret;
+#else
+	if (m_fds.empty()) {
+		CThread::sleep(ms);
+		return 0;
+	}
+
+#if defined(_WIN32) || defined(_WIN64)
+	int ret = ::WSAPoll(m_fds.data(), ULONG(m_fds.size()), int(ms));
+#else
+	int ret = ::poll(m_fds.data(), nfds_t(m_fds.size()), int(ms));
+#endif
+	if (ret < 0) {
+		CThread::sleep(ms);
+		return -1;
+	}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	for (std::vector<pollfd>::const_iterator it = m_fds.begin(); it != m_fds.end(); ++it) {
+		if (((*it).fd == m_wakeFds[0U]) && (((*it).revents & POLLIN) == POLLIN)) {
+			unsigned char buffer[16U];
+			while (::read(m_wakeFds[0U], buffer, 16U) > 0)
+				;
+		}
+	}
+#endif
+
+	return ret;
+#endif
+}
+
+void CPoller::wake()
+{
+#if defined(__linux__)
+	if (m_wakeFd == -1)
+		return;
+
+	uint64_t count = 1U;
+	ssize_t n = ::write(m_wakeFd, &count, sizeof(uint64_t));
+	(void)n;
+#elif !defined(_WIN32) && !defined(_WIN64)
+	if (m_wakeFds[1U] == -1)
+		return;
+
+	unsigned char c = 0U;
+	ssize_t n = ::write(m_wakeFds[1U], &c, 1U);
+	(void)n;
+#endif
+}
+
+void CPoller::close()
+{
+#if defined(__linux__)
+	if (m_wakeFd != -1) {
+		::close(m_wakeFd);
+		m_wakeFd = -1;
+	}
+
+	if (m_fd != -1) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#else
+	m_fds.clear();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_wakeFds[0U] != -1) {
+		::close(m_wakeFds[0U]);
+		::close(m_wakeFds[1U]);
+		m_wakeFds[0U] = -1;
+		m_wakeFds[1U] = -1;
+	}
+#endif
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(Poller_H)
+#define	Poller_H
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <ws2tcpip.h>
+#else
+#include <poll.h>
+#endif
+
+#include <vector>
+
+// Blocks the main loop until one of the registered sockets has data waiting
+// or the timeout expires. Uses epoll on Linux, and poll() elsewhere. Another
+// thread may cut the wait short with wake(), except on Windows.
+class CPoller {
+public:
+	CPoller();
+	~CPoller();
+
+	bool open();
+
+#if defined(_WIN32) || defined(_WIN64)
+	void add(SOCKET fd);
+	void remove(SOCKET fd);
+#else
+	void add(int fd);
+	void remove(int fd);
+#endif
+
+	int  wait(unsigned int ms);
+
+	void wake();
+
+	void close();
+
+private:
+#if defined(__linux__)
+	int                 m_fd;
+	int                 m_wakeFd;
+#else
+	std::vector<pollfd> m_fds;
+#if !defined(_WIN32) && !defined(_WIN64)
+	int                 m_wakeFds[2U];
+#endif
+#endif
+};
+
+#endif
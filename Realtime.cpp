@@ -0,0 +1,198 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Realtime.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+const unsigned int JITTER_SAMPLES = 500U;
+
+#if defined(__linux__)
+static bool      m_saved = false;
+static cpu_set_t m_savedCPUs;
+#endif
+
+CRealtime::CRealtime() :
+m_enabled(false),
+m_priority(0U),
+m_cpus(),
+m_locked(false),
+m_scheduled(false),
+m_pinned(false),
+m_jitterMean(0U),
+m_jitter99(0U),
+m_jitterMax(0U)
+{
+}
+
+bool CRealtime::open(unsigned int priority, const std::vector<unsigned int>& cpus)
+{
+	m_enabled  = true;
+	m_priority = priority;
+	m_cpus     = cpus;
+
+#if defined(__linux__)
+	// Only lock the pages that are actually used, otherwise every thread's stack would be locked in full
+#if defined(MCL_ONFAULT)
+	int flags = MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT;
+#else
+	int flags = MCL_CURRENT | MCL_FUTURE;
+#endif
+	if (::mlockall(flags) == -1)
+		LogWarning("Unable to lock the memory, err: %d", errno);
+	else
+		m_locked = true;
+
+	if (::pthread_getaffinity_np(::pthread_self(), sizeof(cpu_set_t), &m_savedCPUs) == 0)
+		m_saved = true;
+
+	if (!cpus.empty()) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (std::vector<unsigned int>::const_iterator it = cpus.begin(); it != cpus.end(); ++it)
+			CPU_SET(*it, &set);
+
+		int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &set);
+		if (ret != 0)
+			LogWarning("Unable to set the CPU affinity, err: %d", ret);
+		else
+			m_pinned = true;
+	}
+
+	int min = ::sched_get_priority_min(SCHED_FIFO);
+	int max = ::sched_get_priority_max(SCHED_FIFO);
+	if (int(priority) < min || int(priority) > max) {
+		LogWarning("The real-time priority must be between %d and %d", min, max);
+	} else {
+		struct sched_param param;
+		param.sched_priority = int(priority);
+
+		int ret = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param);
+		if (ret != 0)
+			LogWarning("Unable to set the real-time priority, err: %d", ret);
+		else
+			m_scheduled = true;
+	}
+
+	std::string list;
+	for (std::vector<unsigned int>::const_iterator it = cpus.begin(); it != cpus.end(); ++it) {
+		if (!list.empty())
+			list += ",";
+		list += std::to_string(*it);
+	}
+
+	LogInfo("Real-time Parameters");
+	LogInfo("    Memory Locked: %s", m_locked ? "yes" : "no");
+	LogInfo("    Priority: %s", m_scheduled ? std::to_string(priority).c_str() : "none");
+	LogInfo("    CPUs: %s", m_pinned ? list.c_str() : "any");
+
+	return m_locked && m_scheduled && (m_pinned || cpus.empty());
+#else
+	LogWarning("Real-time mode is only supported on Linux, ignoring");
+	return false;
+#endif
+}
+
+void CRealtime::release()
+{
+#if defined(__linux__)
+	if (!m_saved)
+		return;
+
+	struct sched_param param;
+	param.sched_priority = 0;
+
+	int ret = ::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &param);
+	if (ret != 0)
+		LogWarning("Unable to reset the thread priority, err: %d", ret);
+
+	ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &m_savedCPUs);
+	if (ret != 0)
+		LogWarning("Unable to reset the thread CPU affinity, err: %d", ret);
+#endif
+}
+
+void CRealtime::measure()
+{
+#if defined(__linux__)
+	std::vector<unsigned int> lates;
+	lates.reserve(JITTER_SAMPLES);
+
+	unsigned long long total = 0ULL;
+
+	for (unsigned int i = 0U; i < JITTER_SAMPLES; i++) {
+		struct timespec start;
+		::clock_gettime(CLOCK_MONOTONIC, &start);
+
+		struct timespec deadline = start;
+		deadline.tv_nsec += 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+			;
+
+		struct timespec end;
+		::clock_gettime(CLOCK_MONOTONIC, &end);
+
+		long long late = (end.tv_sec - deadline.tv_sec) * 1000000000LL + (end.tv_nsec - deadline.tv_nsec);
+		unsigned int us = (late > 0LL) ? (unsigned int)(late / 1000LL) : 0U;
+
+		lates.push_back(us);
+		total += us;
+	}
+
+	std::sort(lates.begin(), lates.end());
+
+	m_jitterMean = (unsigned int)(total / JITTER_SAMPLES);
+	m_jitter99   = lates[(JITTER_SAMPLES * 99U) / 100U];
+	m_jitterMax  = lates.back();
+
+	LogInfo("Scheduling jitter over %u 1ms sleeps: mean %uus, 99%% %uus, max %uus", JITTER_SAMPLES, m_jitterMean, m_jitter99, m_jitterMax);
+#endif
+}
+
+void CRealtime::writeJSON(nlohmann::json& json) const
+{
+	json["enabled"]       = m_enabled;
+	json["memory_locked"] = m_locked;
+	json["priority"]      = m_scheduled ? m_priority : 0U;
+
+	nlohmann::json cpus = nlohmann::json::array();
+	if (m_pinned) {
+		for (std::vector<unsigned int>::const_iterator it = m_cpus.begin(); it != m_cpus.end(); ++it)
+			cpus.push_back(*it);
+	}
+	json["cpus"] = cpus;
+
+	json["startup_jitter_mean_us"] = m_jitterMean;
+	json["startup_jitter_99_us"]   = m_jitter99;
+	json["startup_jitter_max_us"]  = m_jitterMax;
+}
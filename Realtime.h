@@ -0,0 +1,57 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(Realtime_H)
+#define	Realtime_H
+
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+// Locks the process into memory and gives the calling thread a real-time priority and a set of
+// CPUs. Threads it creates afterwards inherit the priority and the CPUs, so this is done once the
+// MQTT and DNS threads are running and before the network threads are started. Only supported on
+// Linux, and needs root or suitable RLIMIT_RTPRIO and RLIMIT_MEMLOCK limits.
+class CRealtime {
+public:
+	CRealtime();
+
+	bool open(unsigned int priority, const std::vector<unsigned int>& cpus);
+
+	// Puts the calling thread back to normal scheduling on the CPUs the process had before open(),
+	// for a thread started afterwards that only does background work.
+	static void release();
+
+	// Sleeps for 1ms at a time for about half a second, noting how late each wakeup is.
+	void measure();
+
+	void writeJSON(nlohmann::json& json) const;
+
+private:
+	bool                      m_enabled;
+	unsigned int              m_priority;
+	std::vector<unsigned int> m_cpus;
+	bool                      m_locked;
+	bool                      m_scheduled;
+	bool                      m_pinned;
+	unsigned int              m_jitterMean;
+	unsigned int              m_jitter99;
+	unsigned int              m_jitterMax;
+};
+
+#endif
@@ -17,77 +17,77 @@
 */
 
 #include "Reflectors.h"
+#include "Realtime.h"
 #include "Log.h"
 
-#include <algorithm>
-#include <functional>
 #include <cstdio>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
-#include <cctype>
+
+#include <sys/stat.h>
+
+const char* REFLECTOR_DIGITS = "0123456789";
 
 CReflectors::CReflectors(const std::string& hostsFile, unsigned int reloadTime) :
 m_hostsFile(hostsFile),
-m_reflectors(),
-m_timer(1000U, reloadTime * 60U)
+m_table(nullptr),
+m_timer(1000U, reloadTime * 60U),
+m_mtime(0),
+m_size(0),
+m_mutex(),
+m_cond(),
+m_running(false),
+m_reload(false),
+m_loaded(nullptr)
 {
-    if (reloadTime > 0U)
-        m_timer.start();
+	m_table = new CReflectorTable;
+
+	if (reloadTime > 0U)
+		m_timer.start();
 }
 
 CReflectors::~CReflectors()
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
+	stop();
 
-	m_reflectors.clear();
+	delete m_table;
+	delete m_loaded.load();
 }
 
 bool CReflectors::load()
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
-
-	m_reflectors.clear();
+	hasChanged();
 
-	FILE* fp = ::fopen(m_hostsFile.c_str(), "rt");
-	if (fp != nullptr) {
-		char buffer[100U];
-		while (::fgets(buffer, 100U, fp) != nullptr) {
-			if (buffer[0U] == '#')
-				continue;
-
-			char* p1 = ::strtok(buffer, ";\r\n");
-			char* p2 = ::strtok(nullptr, ";\r\n");
-			char* p3 = ::strtok(nullptr, "\r\n");
-
-			if (p1 != nullptr && p2 != nullptr && p3 != nullptr) {
-				CReflector* refl = new CReflector;
-				refl->m_id       = std::string(p1);
-				refl->m_address  = std::string(p2);
-				refl->m_startup  = (unsigned int)::atoi(p3);
-				m_reflectors.push_back(refl);
-			}
-		}
-
-		::fclose(fp);
-	}
+	delete m_table;
+	m_table = parse();
 
-	size_t size = m_reflectors.size();
-	LogInfo("Loaded %u XLX reflectors", size);
+	size_t size = m_table->size();
+	LogInfo("Loaded %u XLX reflectors", (unsigned int)size);
 
-	size = m_reflectors.size();
 	if (size == 0U)
 		return false;
 
+	// Without the thread the file is read again here in clock()
+	if (m_timer.isRunning() && !m_running) {
+		m_running = true;
+
+		bool ret = run();
+		if (!ret) {
+			LogWarning("Unable to start the XLX reflector loading thread");
+			m_running = false;
+		}
+	}
+
 	return true;
 }
 
 CReflector* CReflectors::find(const std::string &id)
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it) {
-		if (id == (*it)->m_id)
-			return *it;
+	if (!id.empty() && (id.find_first_not_of(REFLECTOR_DIGITS) == std::string::npos)) {
+		CReflectorTable::iterator it = m_table->find((unsigned int)::atoi(id.c_str()));
+		if (it != m_table->end())
+			return &it->second;
 	}
 
 	LogMessage("Trying to find non existent XLX reflector with an id of %s", id.c_str());
@@ -97,10 +97,136 @@ CReflector* CReflectors::find(const std::string &id)
 
 void CReflectors::clock(unsigned int ms)
 {
-    m_timer.clock(ms);
+	m_timer.clock(ms);
+	if (m_timer.isRunning() && m_timer.hasExpired()) {
+		if (m_running) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_reload = true;
+			m_cond.notify_one();
+		} else {
+			reload();
+		}
+
+		m_timer.start();
+	}
+
+	if (m_loaded.load(std::memory_order_relaxed) == nullptr)
+		return;
+
+	CReflectorTable* table = m_loaded.exchange(nullptr);
+	if (table != nullptr) {
+		delete m_table;
+		m_table = table;
+
+		LogInfo("Loaded %u XLX reflectors", (unsigned int)m_table->size());
+	}
+}
+
+void CReflectors::entry()
+{
+	// Reading the file is background work, so it mustn't take the real-time priority or CPUs from the networks
+	CRealtime::release();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_running) {
+		if (!m_reload) {
+			m_cond.wait(lock);
+			continue;
+		}
+
+		m_reload = false;
+
+		lock.unlock();
+		reload();
+		lock.lock();
+	}
+}
+
+void CReflectors::reload()
+{
+	if (!hasChanged())
+		return;
+
+	CReflectorTable* table = parse();
+
+	// A file that is being written, or has gone, is no reason to forget the reflectors
+	if (table->empty()) {
+		LogWarning("No XLX reflectors found in %s, keeping the old ones", m_hostsFile.c_str());
+		delete table;
+		return;
+	}
+
+	delete m_loaded.exchange(table);
+}
+
+bool CReflectors::hasChanged()
+{
+	struct stat statStruct;
+	if (::stat(m_hostsFile.c_str(), &statStruct) != 0)
+		return false;
+
+	if ((statStruct.st_mtime == m_mtime) && (statStruct.st_size == m_size))
+		return false;
+
+	m_mtime = statStruct.st_mtime;
+	m_size  = statStruct.st_size;
+
+	return true;
+}
+
+// Doesn't use strtok() as it may run alongside the main thread
+CReflectorTable* CReflectors::parse() const
+{
+	CReflectorTable* table = new CReflectorTable;
+
+	FILE* fp = ::fopen(m_hostsFile.c_str(), "rt");
+	if (fp == nullptr)
+		return table;
+
+	char buffer[100U];
+	while (::fgets(buffer, 100U, fp) != nullptr) {
+		if (buffer[0U] == '#')
+			continue;
+
+		std::string line(buffer);
+		line.erase(line.find_last_not_of("\r\n") + 1U);
+
+		std::string::size_type p1 = line.find(';');
+		if (p1 == std::string::npos)
+			continue;
+
+		std::string::size_type p2 = line.find(';', p1 + 1U);
+		if ((p2 == std::string::npos) || (p2 == (p1 + 1U)) || (p2 == (line.length() - 1U)))
+			continue;
+
+		CReflector refl;
+		refl.m_id      = line.substr(0U, p1);
+		refl.m_address = line.substr(p1 + 1U, p2 - p1 - 1U);
+		refl.m_startup = (unsigned int)::atoi(line.c_str() + p2 + 1U);
+
+		if (refl.m_id.empty() || (refl.m_id.find_first_not_of(REFLECTOR_DIGITS) != std::string::npos))
+			continue;
+
+		// The first entry for a number is the one that is used
+		table->insert(std::make_pair((unsigned int)::atoi(refl.m_id.c_str()), refl));
+	}
+
+	::fclose(fp);
+
+	return table;
+}
+
+void CReflectors::stop()
+{
+	if (!m_running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		m_cond.notify_one();
+	}
 
-    if (m_timer.isRunning() && m_timer.hasExpired()) {
-        load();
-        m_timer.start();
-    }
+	wait();
 }
@@ -19,10 +19,17 @@
 #if !defined(Reflectors_H)
 #define	Reflectors_H
 
+#include "Thread.h"
 #include "Timer.h"
 
-#include <vector>
+#include <condition_variable>
+#include <unordered_map>
+#include <atomic>
 #include <string>
+#include <mutex>
+
+#include <sys/types.h>
+#include <ctime>
 
 class CReflector {
 public:
@@ -38,21 +45,42 @@ public:
 	unsigned int m_startup;
 };
 
-class CReflectors {
+typedef std::unordered_map<unsigned int, CReflector> CReflectorTable;
+
+// The XLX reflectors from the hosts file, by number. The file is read again on a thread of its own
+// each time the reload timer expires, but only if its time or size has changed, and the new table
+// is passed back to be swapped in by clock(), so find() never has to lock anything. Apart from the
+// reloading, must only be used from one thread.
+class CReflectors : public CThread {
 public:
 	CReflectors(const std::string& hostsFile, unsigned int reloadTime);
 	~CReflectors();
 
 	bool load();
 
+	// The reflector is only valid until the next call to clock()
 	CReflector* find(const std::string &id);
 
 	void clock(unsigned int ms);
 
+	virtual void entry();
+
 private:
-	std::string              m_hostsFile;
-	std::vector<CReflector*> m_reflectors;
-	CTimer                   m_timer;
+	std::string                    m_hostsFile;
+	CReflectorTable*               m_table;
+	CTimer                         m_timer;
+	time_t                         m_mtime;
+	off_t                          m_size;
+	std::mutex                     m_mutex;
+	std::condition_variable        m_cond;
+	bool                           m_running;
+	bool                           m_reload;
+	std::atomic<CReflectorTable*>  m_loaded;
+
+	void reload();
+	bool hasChanged();
+	CReflectorTable* parse() const;
+	void stop();
 };
 
 #endif
@@ -112,6 +112,13 @@ REMOTE_COMMAND CRemoteControl::processCommand(const std::string& command)
 			replyStr = "KO";
 
 		m_command = REMOTE_COMMAND::CONFIG_HOSTS;
+	} else if (m_args.at(0U) == "latency") {
+		if (m_host != nullptr)
+			m_host->buildNetworkLatencyString(replyStr);
+		else
+			replyStr = "KO";
+
+		m_command = REMOTE_COMMAND::LATENCY;
 	} else {
 		replyStr = "KO";
 	}
@@ -44,6 +44,7 @@ enum class REMOTE_COMMAND {
 	DISABLE_XLX,
 	CONNECTION_STATUS,
 	CONFIG_HOSTS,
+	LATENCY,
 	NONE
 };
 
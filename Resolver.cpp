@@ -0,0 +1,206 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Resolver.h"
+#include "TimerService.h"
+#include "Log.h"
+
+#include <chrono>
+#include <cstring>
+
+// All in milliseconds
+const unsigned long long RESOLVE_TTL    = 60000ULL;
+const unsigned long long RESOLVE_RETRY  = 10000ULL;
+const unsigned long long RESOLVE_EXPIRY = 3600000ULL;
+const unsigned long long RESOLVE_NEVER  = ~0ULL;
+
+CResolver::CResolver() :
+m_mutex(),
+m_cond(),
+m_entries(),
+m_running(false)
+{
+}
+
+CResolver::~CResolver()
+{
+	stop();
+}
+
+bool CResolver::start()
+{
+	m_running = true;
+
+	bool ret = run();
+	if (!ret) {
+		LogError("Unable to start the DNS resolver thread");
+		m_running = false;
+	}
+
+	return ret;
+}
+
+bool CResolver::lookup(const std::string& hostName, unsigned short port, sockaddr_storage& address, unsigned int& addressLength)
+{
+	CResolverKey key(hostName, port);
+
+	unsigned long long now = CTimerService::now();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::map<CResolverKey, CResolverEntry>::iterator it = m_entries.find(key);
+	if (it != m_entries.end()) {
+		it->second.m_lastUsed = now;
+
+		if (it->second.m_addressLength == 0U)
+			return false;
+
+		::memcpy(&address, &it->second.m_address, sizeof(sockaddr_storage));
+		addressLength = it->second.m_addressLength;
+
+		return true;
+	}
+
+	CResolverEntry entry;
+	::memset(&entry, 0x00U, sizeof(CResolverEntry));
+	entry.m_lastUsed = now;
+
+	// A numeric address doesn't need the DNS, and never changes. Without the thread the DNS has to
+	// be used here and now.
+	if (resolve(key, m_running, entry.m_address, entry.m_addressLength)) {
+		entry.m_refresh = RESOLVE_NEVER;
+		m_entries[key] = entry;
+
+		::memcpy(&address, &entry.m_address, sizeof(sockaddr_storage));
+		addressLength = entry.m_addressLength;
+
+		return true;
+	}
+
+	if (!m_running) {
+		LogError("Cannot find address for host %s", hostName.c_str());
+		return false;
+	}
+
+	entry.m_refresh = 0ULL;
+	m_entries[key] = entry;
+
+	m_cond.notify_one();
+
+	return false;
+}
+
+void CResolver::stop()
+{
+	if (!m_running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+		m_cond.notify_one();
+	}
+
+	wait();
+}
+
+void CResolver::entry()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_running) {
+		unsigned long long now  = CTimerService::now();
+		unsigned long long next = now + RESOLVE_TTL;
+
+		// Find the first lookup that has fallen due, and forget about hosts nobody asks for any more
+		std::map<CResolverKey, CResolverEntry>::iterator due = m_entries.end();
+		for (std::map<CResolverKey, CResolverEntry>::iterator it = m_entries.begin(); it != m_entries.end();) {
+			if ((it->second.m_lastUsed + RESOLVE_EXPIRY) < now) {
+				it = m_entries.erase(it);
+				continue;
+			}
+
+			if (it->second.m_refresh <= now) {
+				due = it;
+				break;
+			}
+
+			if (it->second.m_refresh < next)
+				next = it->second.m_refresh;
+
+			++it;
+		}
+
+		if (due == m_entries.end()) {
+			m_cond.wait_for(lock, std::chrono::milliseconds(next - now));
+			continue;
+		}
+
+		CResolverKey key = due->first;
+
+		// The DNS may take a long time to answer, so don't hold up the networks meanwhile
+		lock.unlock();
+		sockaddr_storage address;
+		unsigned int addressLength = 0U;
+		bool ret = resolve(key, false, address, addressLength);
+		lock.lock();
+
+		std::map<CResolverKey, CResolverEntry>::iterator it = m_entries.find(key);
+		if (it == m_entries.end())
+			continue;
+
+		now = CTimerService::now();
+
+		if (!ret) {
+			// Carry on with the last known address until the DNS can be reached again
+			LogWarning("Cannot find address for host %s", key.first.c_str());
+			it->second.m_refresh = now + RESOLVE_RETRY;
+			continue;
+		}
+
+		if ((it->second.m_addressLength > 0U) && !CUDPSocket::match(it->second.m_address, address))
+			LogMessage("The address of %s has changed", key.first.c_str());
+
+		::memcpy(&it->second.m_address, &address, sizeof(sockaddr_storage));
+		it->second.m_addressLength = addressLength;
+		it->second.m_refresh       = now + RESOLVE_TTL;
+	}
+}
+
+bool CResolver::resolve(const CResolverKey& key, bool numeric, sockaddr_storage& address, unsigned int& addressLength) const
+{
+	struct addrinfo hints;
+	::memset(&hints, 0x00U, sizeof(struct addrinfo));
+	hints.ai_flags = AI_NUMERICSERV;
+	if (numeric)
+		hints.ai_flags |= AI_NUMERICHOST;
+
+	std::string port = std::to_string(key.second);
+
+	struct addrinfo* res = nullptr;
+	int err = ::getaddrinfo(key.first.c_str(), port.c_str(), &hints, &res);
+	if (err != 0)
+		return false;
+
+	addressLength = (unsigned int)res->ai_addrlen;
+	::memcpy(&address, res->ai_addr, addressLength);
+
+	::freeaddrinfo(res);
+
+	return true;
+}
@@ -0,0 +1,66 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(Resolver_H)
+#define	Resolver_H
+
+#include "UDPSocket.h"
+#include "Thread.h"
+
+#include <condition_variable>
+#include <utility>
+#include <string>
+#include <mutex>
+#include <map>
+
+struct CResolverEntry {
+	sockaddr_storage   m_address;
+	unsigned int       m_addressLength;
+	unsigned long long m_refresh;
+	unsigned long long m_lastUsed;
+};
+
+// Looks up host names on a thread of its own so that a slow DNS server never holds up the
+// networks. Each answer is kept for a while and looked up again in the background, so that a
+// master on a dynamic DNS name can be followed to its new address. May be used from any thread.
+class CResolver : public CThread {
+public:
+	CResolver();
+	~CResolver();
+
+	bool start();
+
+	// Returns the address of the host, if it is known, otherwise starts looking it up and returns false.
+	bool lookup(const std::string& hostName, unsigned short port, sockaddr_storage& address, unsigned int& addressLength);
+
+	void stop();
+
+	virtual void entry();
+
+private:
+	typedef std::pair<std::string, unsigned short> CResolverKey;
+
+	std::mutex                             m_mutex;
+	std::condition_variable                m_cond;
+	std::map<CResolverKey, CResolverEntry> m_entries;
+	bool                                   m_running;
+
+	bool resolve(const CResolverKey& key, bool numeric, sockaddr_storage& address, unsigned int& addressLength) const;
+};
+
+#endif
@@ -19,9 +19,9 @@
 #if !defined(REWRITE_H)
 #define	REWRITE_H
 
-#include "DMREmbeddedData.h"
 #include "DMRData.h"
-#include "DMRLC.h"
+
+#include <vector>
 
 enum class PROCESS_RESULT {
 	UNMATCHED,
@@ -29,6 +29,31 @@ enum class PROCESS_RESULT {
 	IGNORED
 };
 
+enum class REWRITE_CALLS {
+	GROUP,
+	PRIVATE,
+	BOTH
+};
+
+const unsigned int REWRITE_ANY_SLOT = 0U;
+const unsigned int REWRITE_MAX_ID   = 0xFFFFFFU;
+
+// A set of frames that a rule may match, by slot, call type and destination id range
+struct CRewriteKey {
+	CRewriteKey(unsigned int slotNo, REWRITE_CALLS calls, unsigned int dstIdStart = 0U, unsigned int dstIdEnd = REWRITE_MAX_ID) :
+	m_slotNo(slotNo),
+	m_calls(calls),
+	m_dstIdStart(dstIdStart),
+	m_dstIdEnd(dstIdEnd)
+	{
+	}
+
+	unsigned int  m_slotNo;
+	REWRITE_CALLS m_calls;
+	unsigned int  m_dstIdStart;
+	unsigned int  m_dstIdEnd;
+};
+
 class CRewrite {
 public:
 	CRewrite();
@@ -36,28 +61,9 @@ public:
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace) = 0;
 
-protected:
-	void processMessage(CDMRData& data);
-
-private:
-	CDMRLC            m_lc;
-	CDMREmbeddedData  m_embeddedLC;
-	CDMREmbeddedData* m_data;
-	unsigned int      m_writeNum;
-	unsigned int      m_readNum;
-	unsigned char     m_lastN;
-
-	void processHeader(CDMRData& data, unsigned char dataType);
-	void processVoiceSync(CDMRData& data);
-	void processVoice(CDMRData& data);
-	void processDataHeader(CDMRData& data);
-	void processData(CDMRData& data);
-	void processCSBK(CDMRData& data);
-	void swap();
-
-	void setLC(FLCO flco, unsigned int srcId, unsigned int dstId);
-
-	void processEmbeddedData(unsigned char* data, unsigned char n);
+	// Adds the frames that process() could do anything other than not match. They may cover
+	// more than that, but never less. By default that is every frame.
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 };
 
 #endif
@@ -27,7 +27,8 @@ CRewriteDstId::CRewriteDstId(const std::string& name, unsigned int fromId, unsig
 CRewrite(),
 m_name(name),
 m_fromId(fromId),
-m_toId(toId)
+m_toId(toId),
+m_rewriteLC()
 {
 }
 
@@ -49,7 +50,7 @@ PROCESS_RESULT CRewriteDstId::process(CDMRData& data, bool trace)
 
 	data.setDstId(m_toId);
 
-	processMessage(data);
+	m_rewriteLC.process(data);
 
 	if (trace) {
 		LogDebug("Rule Trace,\tRewriteDstId from %s Src=%u: matched", m_name.c_str(), m_fromId);
@@ -58,3 +59,8 @@ PROCESS_RESULT CRewriteDstId::process(CDMRData& data, bool trace)
 
 	return PROCESS_RESULT::MATCHED;
 }
+
+void CRewriteDstId::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(REWRITE_ANY_SLOT, REWRITE_CALLS::PRIVATE, m_fromId, m_fromId));
+}
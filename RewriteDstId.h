@@ -19,6 +19,7 @@
 #if !defined(REWRITEDSTID_H)
 #define	REWRITEDSTID_H
 
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -30,11 +31,13 @@ public:
 	virtual ~CRewriteDstId();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 private:
 	std::string  m_name;
 	unsigned int m_fromId;
 	unsigned int m_toId;
+	CRewriteLC   m_rewriteLC;
 };
 
 
@@ -29,7 +29,8 @@ CRewrite(),
 m_name(name),
 m_slot(slot),
 m_toTG(toTG),
-m_currentTG(0U)
+m_currentTG(0U),
+m_rewriteLC()
 {
 	assert(slot == 1U || slot == 2U);
 }
@@ -53,7 +54,7 @@ PROCESS_RESULT CRewriteDynTGNet::process(CDMRData& data, bool trace)
 
 	data.setDstId(m_toTG);
 
-	processMessage(data);
+	m_rewriteLC.process(data);
 
 	if (trace)
 		LogDebug("Rule Trace,\tRewriteDynTGNet from %s Slot=%u Dst=TG%u: matched", m_name.c_str(), m_slot, m_currentTG);
@@ -61,6 +62,12 @@ PROCESS_RESULT CRewriteDynTGNet::process(CDMRData& data, bool trace)
 	return PROCESS_RESULT::MATCHED;
 }
 
+void CRewriteDynTGNet::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	// The current TG changes as it is linked and unlinked, so any destination
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::GROUP));
+}
+
 void CRewriteDynTGNet::setCurrentTG(unsigned int currentTG)
 {
 	m_currentTG = currentTG;
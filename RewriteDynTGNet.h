@@ -19,6 +19,7 @@
 #if !defined(REWRITEDYNTGNET_H)
 #define	REWRITEDYNTGNET_H
 
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -30,6 +31,7 @@ public:
 	virtual ~CRewriteDynTGNet();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 	void setCurrentTG(unsigned int tg);
 
@@ -38,6 +40,7 @@ private:
 	unsigned int      m_slot;
 	unsigned int      m_toTG;
 	unsigned int      m_currentTG;
+	CRewriteLC        m_rewriteLC;
 };
 
 #endif
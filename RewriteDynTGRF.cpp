@@ -37,7 +37,8 @@ m_statusPC(statusPC),
 m_exclTGs(exclTGs),
 m_rewriteNet(rewriteNet),
 m_voice(voice),
-m_currentTG(0U)
+m_currentTG(0U),
+m_rewriteLC()
 {
 	assert(slot == 1U || slot == 2U);
 	assert(rewriteNet != nullptr);
@@ -61,7 +62,7 @@ PROCESS_RESULT CRewriteDynTGRF::process(CDMRData& data, bool trace)
 		if (m_currentTG != 0U) {
 			data.setDstId(m_currentTG);
 
-			processMessage(data);
+			m_rewriteLC.process(data);
 
 			return PROCESS_RESULT::MATCHED;
 		} else {
@@ -76,7 +77,7 @@ PROCESS_RESULT CRewriteDynTGRF::process(CDMRData& data, bool trace)
 		if (m_currentTG != 0U) {
 			data.setFLCO(FLCO::GROUP);
 
-			processMessage(data);
+			m_rewriteLC.process(data);
 
 			if (type == DT_TERMINATOR_WITH_LC) {
 				m_rewriteNet->setCurrentTG(0U);
@@ -122,7 +123,7 @@ PROCESS_RESULT CRewriteDynTGRF::process(CDMRData& data, bool trace)
 
 		data.setFLCO(FLCO::GROUP);
 
-		processMessage(data);
+		m_rewriteLC.process(data);
 
 		if (type == DT_TERMINATOR_WITH_LC) {
 			m_rewriteNet->setCurrentTG(dstId);
@@ -144,6 +145,14 @@ PROCESS_RESULT CRewriteDynTGRF::process(CDMRData& data, bool trace)
 	return PROCESS_RESULT::UNMATCHED;
 }
 
+void CRewriteDynTGRF::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::GROUP, m_toTG, m_toTG));
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::BOTH, m_discPC, m_discPC));
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::BOTH, m_statusPC, m_statusPC));
+	keys.push_back(CRewriteKey(m_slot, REWRITE_CALLS::BOTH, m_fromTGStart, m_fromTGEnd));
+}
+
 void CRewriteDynTGRF::tgChange(unsigned int slot, unsigned int tg)
 {
 	if (slot == m_slot && tg == m_discPC) {
@@ -20,6 +20,7 @@
 #define	REWRITEDYNTGRF_H
 
 #include "DynVoice.h"
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -34,6 +35,7 @@ public:
 	virtual ~CRewriteDynTGRF();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 	void stopVoice(unsigned int slot);
 
@@ -51,6 +53,7 @@ private:
 	CRewriteDynTGNet* m_rewriteNet;
 	CDynVoice*        m_voice;
 	unsigned int      m_currentTG;
+	CRewriteLC        m_rewriteLC;
 };
 
 
@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "RewriteIndex.h"
+
+#include <algorithm>
+#include <cassert>
+
+CRewriteIndex::CRewriteIndex() :
+m_routes(),
+m_keys(),
+m_segments()
+{
+}
+
+CRewriteIndex::~CRewriteIndex()
+{
+}
+
+void CRewriteIndex::add(CRewrite* rewrite, unsigned int network)
+{
+	assert(rewrite != nullptr);
+
+	CRewriteRoute route;
+	route.m_rewrite = rewrite;
+	route.m_network = network;
+	m_routes.push_back(route);
+
+	std::vector<CRewriteKey> keys;
+	rewrite->getKeys(keys);
+	m_keys.push_back(keys);
+}
+
+void CRewriteIndex::compile()
+{
+	compile(1U, true,  m_segments[0U]);
+	compile(1U, false, m_segments[1U]);
+	compile(2U, true,  m_segments[2U]);
+	compile(2U, false, m_segments[3U]);
+
+	m_keys.clear();
+}
+
+void CRewriteIndex::compile(unsigned int slotNo, bool group, std::vector<CRewriteSegment>& segments) const
+{
+	segments.clear();
+
+	// Split the ids up wherever a rule starts or stops, so every id in a segment has the same rules
+	std::vector<unsigned int> starts;
+	starts.push_back(0U);
+
+	for (const std::vector<CRewriteKey>& keys : m_keys) {
+		for (const CRewriteKey& key : keys) {
+			if (key.m_slotNo != REWRITE_ANY_SLOT && key.m_slotNo != slotNo)
+				continue;
+			if (key.m_calls == (group ? REWRITE_CALLS::PRIVATE : REWRITE_CALLS::GROUP))
+				continue;
+			if (key.m_dstIdStart > key.m_dstIdEnd || key.m_dstIdStart > REWRITE_MAX_ID)
+				continue;
+
+			starts.push_back(key.m_dstIdStart);
+			if (key.m_dstIdEnd < REWRITE_MAX_ID)
+				starts.push_back(key.m_dstIdEnd + 1U);
+		}
+	}
+
+	std::sort(starts.begin(), starts.end());
+	starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+	for (unsigned int dstIdStart : starts) {
+		CRewriteSegment segment;
+		segment.m_dstIdStart = dstIdStart;
+
+		for (unsigned int i = 0U; i < m_routes.size(); i++) {
+			for (const CRewriteKey& key : m_keys[i]) {
+				if (key.m_slotNo != REWRITE_ANY_SLOT && key.m_slotNo != slotNo)
+					continue;
+				if (key.m_calls == (group ? REWRITE_CALLS::PRIVATE : REWRITE_CALLS::GROUP))
+					continue;
+
+				if (dstIdStart >= key.m_dstIdStart && dstIdStart <= key.m_dstIdEnd) {
+					segment.m_routes.push_back(m_routes[i]);
+					break;
+				}
+			}
+		}
+
+		// Neighbouring segments with the same rules are merged
+		if (!segments.empty()) {
+			const std::vector<CRewriteRoute>& last = segments.back().m_routes;
+			if (last.size() == segment.m_routes.size() && std::equal(last.cbegin(), last.cend(), segment.m_routes.cbegin(),
+				[](const CRewriteRoute& a, const CRewriteRoute& b) { return a.m_rewrite == b.m_rewrite && a.m_network == b.m_network; }))
+				continue;
+		}
+
+		segments.push_back(segment);
+	}
+}
+
+const std::vector<CRewriteRoute>& CRewriteIndex::find(unsigned int slotNo, FLCO flco, unsigned int dstId, bool trace) const
+{
+	assert(slotNo == 1U || slotNo == 2U);
+
+	if (trace)
+		return m_routes;
+
+	const std::vector<CRewriteSegment>& segments = m_segments[(slotNo - 1U) * 2U + (flco == FLCO::GROUP ? 0U : 1U)];
+	assert(!segments.empty());
+
+	// The last segment starting at or before the id
+	std::vector<CRewriteSegment>::const_iterator it = std::upper_bound(segments.cbegin(), segments.cend(), dstId,
+		[](unsigned int id, const CRewriteSegment& segment) { return id < segment.m_dstIdStart; });
+
+	return (it - 1)->m_routes;
+}
+
+unsigned int CRewriteIndex::getRules() const
+{
+	return (unsigned int)m_routes.size();
+}
+
+unsigned int CRewriteIndex::getSegments() const
+{
+	return (unsigned int)(m_segments[0U].size() + m_segments[1U].size() + m_segments[2U].size() + m_segments[3U].size());
+}
@@ -0,0 +1,64 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(REWRITEINDEX_H)
+#define	REWRITEINDEX_H
+
+#include "Rewrite.h"
+#include "DMRDefines.h"
+
+#include <vector>
+
+struct CRewriteRoute {
+	CRewrite*    m_rewrite;
+	unsigned int m_network;
+};
+
+// Finds the rules that may match a frame by its slot, call type and destination id, in the
+// order that they were added, without walking every rule in turn. Each rule is only a
+// candidate, so its process() still makes the decision and the first match wins as before.
+class CRewriteIndex {
+public:
+	CRewriteIndex();
+	~CRewriteIndex();
+
+	void add(CRewrite* rewrite, unsigned int network);
+
+	// Must be called after the last rule is added and before the first find()
+	void compile();
+
+	// With a trace every rule is returned, so that the trace still shows each rule being tried
+	const std::vector<CRewriteRoute>& find(unsigned int slotNo, FLCO flco, unsigned int dstId, bool trace) const;
+
+	unsigned int getRules() const;
+	unsigned int getSegments() const;
+
+private:
+	struct CRewriteSegment {
+		unsigned int               m_dstIdStart;
+		std::vector<CRewriteRoute> m_routes;
+	};
+
+	std::vector<CRewriteRoute>            m_routes;
+	std::vector<std::vector<CRewriteKey>> m_keys;
+	std::vector<CRewriteSegment>          m_segments[4U];
+
+	void compile(unsigned int slotNo, bool group, std::vector<CRewriteSegment>& segments) const;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+*   Copyright (C) 2017,2020,2025 by Jonathan Naylor G4KLX
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(REWRITELC_H)
+#define	REWRITELC_H
+
+#include "DMREmbeddedData.h"
+#include "DMRData.h"
+#include "DMRLC.h"
+
+const unsigned int REWRITE_LC_STREAMS = 4U;
+
+// Carries the source and destination ids of a rewritten frame into the full LC, the embedded LC,
+// the data header or the CSBK held within it, for one stream.
+class CRewriteLCStream {
+public:
+	CRewriteLCStream();
+	~CRewriteLCStream();
+
+	void reset();
+
+	void process(CDMRData& data);
+
+private:
+	CDMRLC            m_lc;
+	bool              m_hasLC;
+	CDMREmbeddedData  m_embeddedLC;
+	CDMREmbeddedData  m_data[2U];
+	unsigned int      m_writeNum;
+	unsigned int      m_readNum;
+	unsigned char     m_lastN;
+
+	void processHeader(CDMRData& data, unsigned char dataType);
+	void processVoiceSync(CDMRData& data);
+	void processVoice(CDMRData& data);
+	void processDataHeader(CDMRData& data);
+	void processData(CDMRData& data);
+	void processCSBK(CDMRData& data);
+	void swap();
+
+	void setLC(FLCO flco, unsigned int srcId, unsigned int dstId);
+
+	void processEmbeddedData(unsigned char* data, unsigned char n);
+};
+
+// The LC rewriting for each of the streams going through one rule, found by stream id, so that
+// streams on both slots, or from more than one network, don't disturb each other. An entry is
+// freed by the stream's terminator, or else taken by a new stream once it's the least recently used.
+// Only the rules that change the ids need one.
+class CRewriteLC {
+public:
+	CRewriteLC();
+	~CRewriteLC();
+
+	void process(CDMRData& data);
+
+private:
+	CRewriteLCStream m_streams[REWRITE_LC_STREAMS];
+	unsigned int     m_streamIds[REWRITE_LC_STREAMS];
+	unsigned int     m_lastUsed[REWRITE_LC_STREAMS];
+	bool             m_inUse[REWRITE_LC_STREAMS];
+	unsigned int     m_tick;
+};
+
+#endif
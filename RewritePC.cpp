@@ -32,7 +32,8 @@ m_fromIdStart(fromId),
 m_fromIdEnd(fromId + range - 1U),
 m_toSlot(toSlot),
 m_toIdStart(toId),
-m_toIdEnd(toId + range - 1U)
+m_toIdEnd(toId + range - 1U),
+m_rewriteLC()
 {
 	assert(fromSlot == 1U || fromSlot == 2U);
 	assert(toSlot == 1U || toSlot == 2U);
@@ -62,7 +63,7 @@ PROCESS_RESULT CRewritePC::process(CDMRData& data, bool trace)
 		unsigned int newDstId = dstId + m_toIdStart - m_fromIdStart;
 		data.setDstId(newDstId);
 
-		processMessage(data);
+		m_rewriteLC.process(data);
 	}
 
 	if (trace) {
@@ -72,3 +73,8 @@ PROCESS_RESULT CRewritePC::process(CDMRData& data, bool trace)
 
 	return PROCESS_RESULT::MATCHED;
 }
+
+void CRewritePC::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_fromSlot, REWRITE_CALLS::PRIVATE, m_fromIdStart, m_fromIdEnd));
+}
@@ -31,7 +31,8 @@ m_fromSlot(fromSlot),
 m_fromIdStart(fromId),
 m_fromIdEnd(fromId + range - 1U),
 m_toSlot(toSlot),
-m_toTG(toTG)
+m_toTG(toTG),
+m_rewriteLC()
 {
 	assert(fromSlot == 1U || fromSlot == 2U);
 	assert(toSlot == 1U || toSlot == 2U);
@@ -60,7 +61,7 @@ PROCESS_RESULT CRewriteSrc::process(CDMRData& data, bool trace)
 	data.setDstId(m_toTG);
 	data.setFLCO(FLCO::GROUP);
 
-	processMessage(data);
+	m_rewriteLC.process(data);
 
 	if (trace) {
 		LogDebug("Rule Trace,\tRewriteSrc from %s Slot=%u Src=%u-%u: matched", m_name.c_str(), m_fromSlot, m_fromIdStart, m_fromIdEnd);
@@ -69,3 +70,9 @@ PROCESS_RESULT CRewriteSrc::process(CDMRData& data, bool trace)
 
 	return PROCESS_RESULT::MATCHED;
 }
+
+void CRewriteSrc::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	// Matched on the source id, so any destination
+	keys.push_back(CRewriteKey(m_fromSlot, REWRITE_CALLS::PRIVATE));
+}
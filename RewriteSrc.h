@@ -19,6 +19,7 @@
 #if !defined(REWRITESRC_H)
 #define	REWRITESRC_H
 
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -30,6 +31,7 @@ public:
 	virtual ~CRewriteSrc();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 private:
 	std::string  m_name;
@@ -38,6 +40,7 @@ private:
 	unsigned int m_fromIdEnd;
 	unsigned int m_toSlot;
 	unsigned int m_toTG;
+	CRewriteLC   m_rewriteLC;
 };
 
 
@@ -27,7 +27,8 @@ CRewriteSrcId::CRewriteSrcId(const std::string& name, unsigned int fromId, unsig
 CRewrite(),
 m_name(name),
 m_fromId(fromId),
-m_toId(toId)
+m_toId(toId),
+m_rewriteLC()
 {
 }
 
@@ -48,7 +49,7 @@ PROCESS_RESULT CRewriteSrcId::process(CDMRData& data, bool trace)
 
 	data.setSrcId(m_toId);
 
-	processMessage(data);
+	m_rewriteLC.process(data);
 
 	if (trace) {
 		LogDebug("Rule Trace,\tRewriteSrcId from %s Src=%u: matched", m_name.c_str(), m_fromId);
@@ -19,6 +19,7 @@
 #if !defined(REWRITESRCID_H)
 #define	REWRITESRCID_H
 
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -35,6 +36,7 @@ private:
 	std::string  m_name;
 	unsigned int m_fromId;
 	unsigned int m_toId;
+	CRewriteLC   m_rewriteLC;
 };
 
 
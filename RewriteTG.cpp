@@ -32,7 +32,8 @@ m_fromTGStart(fromTG),
 m_fromTGEnd(fromTG + range - 1U),
 m_toSlot(toSlot),
 m_toTGStart(toTG),
-m_toTGEnd(toTG + range - 1U)
+m_toTGEnd(toTG + range - 1U),
+m_rewriteLC()
 {
 	assert(fromSlot == 1U || fromSlot == 2U);
 	assert(toSlot == 1U || toSlot == 2U);
@@ -66,7 +67,7 @@ PROCESS_RESULT CRewriteTG::process(CDMRData& data, bool trace)
 		unsigned int newTG = dstId + m_toTGStart - m_fromTGStart;
 		data.setDstId(newTG);
 
-		processMessage(data);
+		m_rewriteLC.process(data);
 	}
 
 	if (trace) {
@@ -83,3 +84,8 @@ PROCESS_RESULT CRewriteTG::process(CDMRData& data, bool trace)
 
 	return PROCESS_RESULT::MATCHED;
 }
+
+void CRewriteTG::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_fromSlot, REWRITE_CALLS::GROUP, m_fromTGStart, m_fromTGEnd));
+}
@@ -32,7 +32,8 @@ m_fromTGStart(fromTG),
 m_fromTGEnd(fromTG + range - 1U),
 m_toSlot(toSlot),
 m_toIdStart(toId),
-m_toIdEnd(toId + range - 1U)
+m_toIdEnd(toId + range - 1U),
+m_rewriteLC()
 {
 	assert(fromSlot == 1U || fromSlot == 2U);
 	assert(toSlot == 1U || toSlot == 2U);
@@ -67,7 +68,7 @@ PROCESS_RESULT CRewriteType::process(CDMRData& data, bool trace)
 	}
 	data.setFLCO(FLCO::USER_USER);
 
-	processMessage(data);
+	m_rewriteLC.process(data);
 
 	if (trace) {
 		if (m_fromTGStart == m_fromTGEnd)
@@ -82,3 +83,8 @@ PROCESS_RESULT CRewriteType::process(CDMRData& data, bool trace)
 
 	return PROCESS_RESULT::MATCHED;
 }
+
+void CRewriteType::getKeys(std::vector<CRewriteKey>& keys) const
+{
+	keys.push_back(CRewriteKey(m_fromSlot, REWRITE_CALLS::GROUP, m_fromTGStart, m_fromTGEnd));
+}
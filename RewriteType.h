@@ -19,6 +19,7 @@
 #if !defined(REWRITETYPE_H)
 #define	REWRITETYPE_H
 
+#include "RewriteLC.h"
 #include "Rewrite.h"
 #include "DMRData.h"
 
@@ -30,6 +31,7 @@ public:
 	virtual ~CRewriteType();
 
 	virtual PROCESS_RESULT process(CDMRData& data, bool trace);
+	virtual void getKeys(std::vector<CRewriteKey>& keys) const;
 
 private:
 	std::string  m_name;
@@ -39,6 +41,7 @@ private:
 	unsigned int m_toSlot;
 	unsigned int m_toIdStart;
 	unsigned int m_toIdEnd;
+	CRewriteLC   m_rewriteLC;
 };
 
 
@@ -25,10 +25,14 @@
 #include <cassert>
 #include <cstring>
 
+// The capacity is rounded up to a power of two so that the free running read and write counters
+// only need masking, and every operation is at most two memcpy() calls either side of the wrap,
+// which means T must be safe to copy with memcpy().
 template<class T> class CRingBuffer {
 public:
 	CRingBuffer(unsigned int length, const char* name) :
-	m_length(length),
+	m_length(1U),
+	m_mask(0U),
 	m_name(name),
 	m_buffer(nullptr),
 	m_iPtr(0U),
@@ -37,7 +41,11 @@ public:
 		assert(length > 0U);
 		assert(name != nullptr);
 
-		m_buffer = new T[length];
+		while (m_length < length)
+			m_length <<= 1;
+		m_mask = m_length - 1U;
+
+		m_buffer = new T[m_length];
 
 		::memset(m_buffer, 0x00, m_length * sizeof(T));
 	}
@@ -55,13 +63,17 @@ public:
 			return false;
 		}
 
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			m_buffer[m_iPtr++] = buffer[i];
-
-			if (m_iPtr == m_length)
-				m_iPtr = 0U;
+		unsigned int ptr   = m_iPtr & m_mask;
+		unsigned int first = m_length - ptr;
+		if (first >= nSamples) {
+			::memcpy(m_buffer + ptr, buffer, nSamples * sizeof(T));
+		} else {
+			::memcpy(m_buffer + ptr, buffer, first * sizeof(T));
+			::memcpy(m_buffer, buffer + first, (nSamples - first) * sizeof(T));
 		}
 
+		m_iPtr += nSamples;
+
 		return true;
 	}
 
@@ -72,12 +84,9 @@ public:
 			return false;
 		}
 
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			buffer[i] = m_buffer[m_oPtr++];
+		copyOut(buffer, nSamples);
 
-			if (m_oPtr == m_length)
-				m_oPtr = 0U;
-		}
+		m_oPtr += nSamples;
 
 		return true;
 	}
@@ -89,13 +98,7 @@ public:
 			return false;
 		}
 
-		unsigned int ptr = m_oPtr;
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			buffer[i] = m_buffer[ptr++];
-
-			if (ptr == m_length)
-				ptr = 0U;
-		}
+		copyOut(buffer, nSamples);
 
 		return true;
 	}
@@ -104,28 +107,16 @@ public:
 	{
 		m_iPtr = 0U;
 		m_oPtr = 0U;
-
-		::memset(m_buffer, 0x00, m_length * sizeof(T));
 	}
 
 	unsigned int freeSpace() const
 	{
-		unsigned int len = m_length;
-
-		if (m_oPtr > m_iPtr)
-			len = m_oPtr - m_iPtr;
-		else if (m_iPtr > m_oPtr)
-			len = m_length - (m_iPtr - m_oPtr);
-
-		if (len > m_length)
-			len = 0U;
-
-		return len;
+		return m_length - dataSize();
 	}
 
 	unsigned int dataSize() const
 	{
-		return m_length - freeSpace();
+		return m_iPtr - m_oPtr;
 	}
 
 	bool hasSpace(unsigned int length) const
@@ -145,10 +136,23 @@ public:
 
 private:
 	unsigned int m_length;
+	unsigned int m_mask;
 	const char*  m_name;
 	T*           m_buffer;
 	unsigned int m_iPtr;
 	unsigned int m_oPtr;
+
+	void copyOut(T* buffer, unsigned int nSamples) const
+	{
+		unsigned int ptr   = m_oPtr & m_mask;
+		unsigned int first = m_length - ptr;
+		if (first >= nSamples) {
+			::memcpy(buffer, m_buffer + ptr, nSamples * sizeof(T));
+		} else {
+			::memcpy(buffer, m_buffer + ptr, first * sizeof(T));
+			::memcpy(buffer + first, m_buffer, (nSamples - first) * sizeof(T));
+		}
+	}
 };
 
 #endif
@@ -0,0 +1,203 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef SPSCRing_H
+#define SPSCRing_H
+
+#include <atomic>
+#include <cassert>
+
+// The producer's and the consumer's halves are kept this far apart so they never share a cache line
+const unsigned int SPSC_CACHE_LINE = 64U;
+
+// A lock-free ring of whole items for handing work from exactly one producer thread to exactly one
+// consumer thread. push() may only be called by the producer and pop() by the consumer. Each side
+// keeps its own index on its own cache line, along with the last value it saw of the other side's,
+// so the other side's line is only fetched when the ring looks full or empty.
+template<class T> class CSPSCRing {
+public:
+	CSPSCRing(unsigned int length, const char* name) :
+	m_length(length),
+	m_name(name),
+	m_buffer(nullptr),
+	m_iPtr(0U),
+	m_oPtrCache(0U),
+	m_maxDepth(0U),
+	m_dropped(0U),
+	m_oPtr(0U),
+	m_iPtrCache(0U)
+	{
+		assert(length > 1U);
+		assert(name != nullptr);
+
+		m_buffer = new T[length];
+	}
+
+	~CSPSCRing()
+	{
+		delete[] m_buffer;
+	}
+
+	bool push(const T& item)
+	{
+		return push(&item, 1U) == 1U;
+	}
+
+	// Pushes as many of the items as there is room for and returns how many that was, the rest are
+	// counted as dropped
+	unsigned int push(const T* items, unsigned int count)
+	{
+		assert(items != nullptr);
+
+		unsigned int iPtr = m_iPtr.load(std::memory_order_relaxed);
+
+		unsigned int space = freeSpace(iPtr, m_oPtrCache);
+		if (space < count) {
+			m_oPtrCache = m_oPtr.load(std::memory_order_acquire);
+			space = freeSpace(iPtr, m_oPtrCache);
+		}
+
+		unsigned int n = (count < space) ? count : space;
+		for (unsigned int i = 0U; i < n; i++) {
+			m_buffer[iPtr] = items[i];
+
+			iPtr++;
+			if (iPtr == m_length)
+				iPtr = 0U;
+		}
+
+		if (n > 0U) {
+			m_iPtr.store(iPtr, std::memory_order_release);
+
+			// Measured against the consumer's index as last seen, so it may be a little high
+			unsigned int depth = (m_length - 1U) - freeSpace(iPtr, m_oPtrCache);
+			if (depth > m_maxDepth.load(std::memory_order_relaxed))
+				m_maxDepth.store(depth, std::memory_order_relaxed);
+		}
+
+		if (n < count)
+			m_dropped.fetch_add(count - n, std::memory_order_relaxed);
+
+		return n;
+	}
+
+	bool pop(T& item)
+	{
+		return pop(&item, 1U) == 1U;
+	}
+
+	// Takes up to count items and returns how many there were
+	unsigned int pop(T* items, unsigned int count)
+	{
+		assert(items != nullptr);
+
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+
+		unsigned int available = dataSize(m_iPtrCache, oPtr);
+		if (available < count) {
+			m_iPtrCache = m_iPtr.load(std::memory_order_acquire);
+			available = dataSize(m_iPtrCache, oPtr);
+		}
+
+		unsigned int n = (count < available) ? count : available;
+		for (unsigned int i = 0U; i < n; i++) {
+			items[i] = m_buffer[oPtr];
+
+			oPtr++;
+			if (oPtr == m_length)
+				oPtr = 0U;
+		}
+
+		if (n > 0U)
+			m_oPtr.store(oPtr, std::memory_order_release);
+
+		return n;
+	}
+
+	// How many more items there is room for, only to be called by the producer
+	unsigned int space()
+	{
+		m_oPtrCache = m_oPtr.load(std::memory_order_acquire);
+
+		return freeSpace(m_iPtr.load(std::memory_order_relaxed), m_oPtrCache);
+	}
+
+	bool isEmpty() const
+	{
+		return m_oPtr.load(std::memory_order_acquire) == m_iPtr.load(std::memory_order_acquire);
+	}
+
+	unsigned int depth() const
+	{
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+
+		return dataSize(iPtr, oPtr);
+	}
+
+	// The deepest the ring has been since the last call
+	unsigned int getMaxDepth()
+	{
+		return m_maxDepth.exchange(0U);
+	}
+
+	unsigned int getDropped() const
+	{
+		return m_dropped.load();
+	}
+
+	const char* getName() const
+	{
+		return m_name;
+	}
+
+private:
+	// Fixed once constructed
+	unsigned int              m_length;
+	const char*               m_name;
+	T*                        m_buffer;
+	char                      m_pad1[SPSC_CACHE_LINE];
+
+	// Written by the producer
+	std::atomic<unsigned int> m_iPtr;
+	unsigned int              m_oPtrCache;
+	std::atomic<unsigned int> m_maxDepth;
+	std::atomic<unsigned int> m_dropped;
+	char                      m_pad2[SPSC_CACHE_LINE];
+
+	// Written by the consumer
+	std::atomic<unsigned int> m_oPtr;
+	unsigned int              m_iPtrCache;
+	char                      m_pad3[SPSC_CACHE_LINE];
+
+	unsigned int dataSize(unsigned int iPtr, unsigned int oPtr) const
+	{
+		if (iPtr >= oPtr)
+			return iPtr - oPtr;
+		else
+			return m_length - (oPtr - iPtr);
+	}
+
+	// One slot is always left empty so that a full ring can be told from an empty one
+	unsigned int freeSpace(unsigned int iPtr, unsigned int oPtr) const
+	{
+		return (m_length - 1U) - dataSize(iPtr, oPtr);
+	}
+};
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+// Checks that forwarding frames allocates nothing once it has warmed up. Voice streams go through
+// a CSPSCRing of CDMRData, copies of the frame, a talk group rewrite and the restart of the slot
+// timers for each frame, with every operator new counted. Run it with "make check".
+
+#include "DMRDefines.h"
+#include "TimerService.h"
+#include "RewriteTG.h"
+#include "SPSCRing.h"
+#include "DMRData.h"
+#include "Timer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+const unsigned int WARM_UP_STREAMS = 10U;
+const unsigned int STREAMS         = 100U;
+const unsigned int SUPERFRAMES     = 20U;
+
+static bool               s_counting    = false;
+static unsigned long long s_allocations = 0ULL;
+
+void* operator new(std::size_t size)
+{
+	if (s_counting)
+		s_allocations++;
+
+	void* p = std::malloc(size == 0U ? 1U : size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+static void expired(void* param)
+{
+	unsigned int* count = static_cast<unsigned int*>(param);
+	(*count)++;
+}
+
+// The gateway's side of the link, for one slot of the repeater and one network
+class CForwarder {
+public:
+	CForwarder() :
+	m_queue(64U, "forwarder"),
+	m_rule("TG", 2U, 9U, 2U, 91U, 1U),
+	m_rfTimer(1000U, 10U),
+	m_netTimer(1000U, 30U),
+	m_pollTimer(1000U, 0U, 1U),
+	m_polls(0U),
+	m_frames(0U)
+	{
+		m_pollTimer.setCallback(expired, &m_polls);
+	}
+
+	void forward(const CDMRData& data)
+	{
+		m_queue.push(data);
+
+		CDMRData frame;
+		while (m_queue.pop(frame)) {
+			CDMRData copy = frame;
+
+			if (m_rule.process(copy, false) == PROCESS_RESULT::MATCHED)
+				m_frames++;
+
+			m_rfTimer.start();
+			m_netTimer.start();
+
+			if (!m_pollTimer.isRunning())
+				m_pollTimer.start();
+
+			CTimerService::clock();
+		}
+	}
+
+	unsigned int getFrames() const
+	{
+		return m_frames;
+	}
+
+	unsigned int getPolls() const
+	{
+		return m_polls;
+	}
+
+private:
+	CSPSCRing<CDMRData> m_queue;
+	CRewriteTG          m_rule;
+	CTimer              m_rfTimer;
+	CTimer              m_netTimer;
+	CTimer              m_pollTimer;
+	unsigned int        m_polls;
+	unsigned int        m_frames;
+};
+
+// A voice stream on TG 9 of slot 2, a header, superframes of six voice frames, and a terminator
+static void sendStream(CForwarder& forwarder, unsigned int streamId)
+{
+	unsigned char buffer[DMR_FRAME_LENGTH_BYTES];
+
+	CDMRData data;
+	data.setSlotNo(2U);
+	data.setSrcId(2345678U);
+	data.setDstId(9U);
+	data.setFLCO(FLCO::GROUP);
+	data.setStreamId(streamId);
+
+	unsigned char seqNo = 0U;
+
+	::memset(buffer, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	data.setData(buffer);
+	data.setDataType(DT_VOICE_LC_HEADER);
+	data.setSeqNo(seqNo++);
+	forwarder.forward(data);
+
+	for (unsigned int i = 0U; i < SUPERFRAMES; i++) {
+		for (unsigned char n = 0U; n < 6U; n++) {
+			::memset(buffer, (i * 6U + n) & 0xFFU, DMR_FRAME_LENGTH_BYTES);
+			data.setData(buffer);
+			data.setDataType(n == 0U ? DT_VOICE_SYNC : DT_VOICE);
+			data.setN(n);
+			data.setSeqNo(seqNo++);
+			forwarder.forward(data);
+		}
+	}
+
+	::memset(buffer, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	data.setData(buffer);
+	data.setDataType(DT_TERMINATOR_WITH_LC);
+	data.setSeqNo(seqNo++);
+	forwarder.forward(data);
+}
+
+int main()
+{
+	CForwarder forwarder;
+
+	unsigned int streamId = 1U;
+
+	// Carry on until the poll timer has fired, which grows the list of expired timers the first time
+	for (unsigned int i = 0U; i < WARM_UP_STREAMS || forwarder.getPolls() == 0U; i++)
+		sendStream(forwarder, streamId++);
+
+	unsigned int frames = forwarder.getFrames();
+
+	s_counting = true;
+
+	for (unsigned int i = 0U; i < STREAMS; i++)
+		sendStream(forwarder, streamId++);
+
+	s_counting = false;
+
+	frames = forwarder.getFrames() - frames;
+
+	if (frames != STREAMS * (SUPERFRAMES * 6U + 2U)) {
+		::fprintf(stderr, "Forwarding: only %u frames were rewritten\n", frames);
+		return 1;
+	}
+
+	if (s_allocations > 0ULL) {
+		::fprintf(stderr, "Forwarding: %llu allocations for %u frames\n", s_allocations, frames);
+		return 1;
+	}
+
+	::fprintf(stdout, "Forwarding: no allocations for %u frames\n", frames);
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Times CBPTC19696 encoding and decoding a frame, and making a codec and encoding with it as
+// CDMRCSBK and CDMRDataHeader do for every call. Run it with "make bench".
+
+#include "BPTC19696.h"
+
+#include <chrono>
+#include <cstdio>
+
+const unsigned int ITERATIONS = 1000000U;
+
+int main()
+{
+	unsigned char payload[12U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU, 0x0BU, 0x0CU};
+	unsigned char frame[33U] = {0x00U};
+	unsigned char out[12U];
+
+	unsigned int sum = 0U;
+
+	CBPTC19696 bptc;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0U; i < ITERATIONS; i++) {
+		payload[0U] = i;
+		bptc.encode(payload, frame);
+		sum += frame[5U];
+	}
+
+	std::chrono::steady_clock::time_point encoded = std::chrono::steady_clock::now();
+
+	// A changing single bit error, so the corrections are exercised too
+	for (unsigned int i = 0U; i < ITERATIONS; i++) {
+		frame[i % 12U] ^= 0x01U;
+		bptc.decode(frame, out);
+		sum += out[3U];
+	}
+
+	std::chrono::steady_clock::time_point decoded = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0U; i < ITERATIONS; i++) {
+		CBPTC19696 local;
+		payload[0U] = i;
+		local.encode(payload, frame);
+		sum += frame[5U];
+	}
+
+	std::chrono::steady_clock::time_point constructed = std::chrono::steady_clock::now();
+
+	// Keeps the work from being optimised away
+	if (sum == 1U)
+		::fprintf(stderr, "%u\n", sum);
+
+	::fprintf(stdout, "CBPTC19696: encode %.1f ns, decode %.1f ns, construct and encode %.1f ns per frame\n",
+		std::chrono::duration<double, std::nano>(encoded - start).count() / ITERATIONS,
+		std::chrono::duration<double, std::nano>(decoded - encoded).count() / ITERATIONS,
+		std::chrono::duration<double, std::nano>(constructed - decoded).count() / ITERATIONS);
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Checks CBPTC19696 against the golden vectors in BPTC19696.txt, which were made with the codec
+// it replaced. Run it with "make check".
+
+#include "BPTC19696.h"
+
+#include <cstdio>
+#include <cstring>
+
+static bool fromHex(const char* text, unsigned char* data, unsigned int length)
+{
+	for (unsigned int i = 0U; i < length; i++) {
+		unsigned int value;
+		if (::sscanf(text + i * 2U, "%2x", &value) != 1)
+			return false;
+
+		data[i] = value;
+	}
+
+	return text[length * 2U] == ' ' || text[length * 2U] == '\n' || text[length * 2U] == '\0';
+}
+
+int main(int argc, char** argv)
+{
+	const char* fileName = (argc > 1) ? argv[1] : "Tests/BPTC19696.txt";
+
+	FILE* fp = ::fopen(fileName, "rt");
+	if (fp == nullptr) {
+		::fprintf(stderr, "CBPTC19696: cannot open %s\n", fileName);
+		return 1;
+	}
+
+	CBPTC19696 bptc;
+
+	unsigned int encodes = 0U, decodes = 0U, errors = 0U, line = 0U;
+
+	char buffer[200U];
+	while (::fgets(buffer, 200U, fp) != nullptr) {
+		line++;
+
+		if (buffer[0U] == '#')
+			continue;
+
+		unsigned char payload[12U], frame[33U], expected[33U], out[33U];
+
+		if (buffer[0U] == 'E' && fromHex(buffer + 2U, payload, 12U) && fromHex(buffer + 27U, frame, 33U) && fromHex(buffer + 94U, expected, 33U)) {
+			bptc.encode(payload, frame);
+
+			if (::memcmp(frame, expected, 33U) != 0) {
+				::fprintf(stderr, "CBPTC19696: encode() differs from the golden vector on line %u\n", line);
+				errors++;
+			}
+
+			encodes++;
+		} else if (buffer[0U] == 'D' && fromHex(buffer + 2U, frame, 33U) && fromHex(buffer + 69U, expected, 12U)) {
+			bptc.decode(frame, out);
+
+			if (::memcmp(out, expected, 12U) != 0) {
+				::fprintf(stderr, "CBPTC19696: decode() differs from the golden vector on line %u\n", line);
+				errors++;
+			}
+
+			decodes++;
+		} else {
+			::fprintf(stderr, "CBPTC19696: cannot parse line %u of %s\n", line, fileName);
+			errors++;
+		}
+	}
+
+	::fclose(fp);
+
+	if (errors > 0U || encodes == 0U || decodes == 0U) {
+		::fprintf(stderr, "CBPTC19696: %u of %u golden vectors failed\n", errors, encodes + decodes);
+		return 1;
+	}
+
+	::fprintf(stdout, "CBPTC19696: %u encode and %u decode golden vectors passed\n", encodes, decodes);
+
+	return 0;
+}
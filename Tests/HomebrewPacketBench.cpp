@@ -0,0 +1,107 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Times CHomebrewPacket::classify() against the chain of memcmp() calls it replaced, for each kind
+// of packet in turn. Run it with "make bench".
+
+#include "HomebrewPacket.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+const unsigned int PACKET_COUNT  = 64U;
+const unsigned int PACKET_LENGTH = 55U;
+const unsigned int ITERATIONS    = 20000000U;
+
+// The order the networks tested the names in before, with trunking enabled
+static HOMEBREW_PACKET baseline(const unsigned char* packet, unsigned int)
+{
+	if (::memcmp(packet, "DMRT", 4U) == 0)
+		return HOMEBREW_PACKET::DMRT;
+	else if (::memcmp(packet, "DMRD", 4U) == 0)
+		return HOMEBREW_PACKET::DMRD;
+	else if (::memcmp(packet, "MSTNAK", 6U) == 0)
+		return HOMEBREW_PACKET::MSTNAK;
+	else if (::memcmp(packet, "RPTACK", 6U) == 0)
+		return HOMEBREW_PACKET::RPTACK;
+	else if (::memcmp(packet, "MSTCL", 5U) == 0)
+		return HOMEBREW_PACKET::MSTCL;
+	else if (::memcmp(packet, "MSTPONG", 7U) == 0)
+		return HOMEBREW_PACKET::MSTPONG;
+	else if (::memcmp(packet, "RPTSBKN", 7U) == 0)
+		return HOMEBREW_PACKET::RPTSBKN;
+	else if (::memcmp(packet, "DTCNAK", 6U) == 0)
+		return HOMEBREW_PACKET::DTCNAK;
+	else if (::memcmp(packet, "DTCACK", 6U) == 0)
+		return HOMEBREW_PACKET::DTCACK;
+	else if (::memcmp(packet, "DTCCL", 5U) == 0)
+		return HOMEBREW_PACKET::DTCCL;
+	else if (::memcmp(packet, "DTCPONG", 7U) == 0)
+		return HOMEBREW_PACKET::DTCPONG;
+	else if (::memcmp(packet, "DTCSBKN", 7U) == 0)
+		return HOMEBREW_PACKET::DTCSBKN;
+	else
+		return HOMEBREW_PACKET::UNKNOWN;
+}
+
+static unsigned char PACKETS[PACKET_COUNT][PACKET_LENGTH];
+
+// Returns the nanoseconds for each packet classified
+template<HOMEBREW_PACKET (*CLASSIFY)(const unsigned char*, unsigned int)> static double measure(unsigned int& sum)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0U; i < ITERATIONS; i++)
+		sum += (unsigned int)CLASSIFY(PACKETS[i % PACKET_COUNT], PACKET_LENGTH);
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+int main()
+{
+	static const char* NAMES[] = {"DMRD", "DMRT", "RPTACK", "MSTPONG", "DTCSBKN", "XXXX"};
+
+	unsigned int sum = 0U;
+
+	for (unsigned int i = 0U; i < 6U; i++) {
+		for (unsigned int j = 0U; j < PACKET_COUNT; j++) {
+			for (unsigned int k = 0U; k < PACKET_LENGTH; k++)
+				PACKETS[j][k] = j + k;
+			::memcpy(PACKETS[j], NAMES[i], ::strlen(NAMES[i]));
+		}
+
+		if (CHomebrewPacket::classify(PACKETS[0U], PACKET_LENGTH) != baseline(PACKETS[0U], PACKET_LENGTH)) {
+			::fprintf(stderr, "CHomebrewPacket: %s is classified differently from the baseline\n", NAMES[i]);
+			return 1;
+		}
+
+		double before = measure<baseline>(sum);
+		double after  = measure<CHomebrewPacket::classify>(sum);
+
+		::fprintf(stdout, "CHomebrewPacket: %-7s %.2f ns per packet before, %.2f ns after\n", NAMES[i], before, after);
+	}
+
+	// Keeps the work from being optimised away
+	if (sum == 1U)
+		::fprintf(stderr, "%u\n", sum);
+
+	return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Times CRingBuffer against the element at a time ring it replaced, moving frames the way the
+// networks queue them: a length byte, an eight byte timestamp and the payload. Run it with
+// "make bench".
+
+#include "RingBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+const unsigned int RING_LENGTH = 1000U;
+const unsigned int ITERATIONS  = 20000000U;
+
+// The ring as it was before the bulk copy rework, kept as the baseline
+template<class T> class CBaselineRingBuffer {
+public:
+	CBaselineRingBuffer(unsigned int length, const char* name) :
+	m_length(length),
+	m_buffer(nullptr),
+	m_iPtr(0U),
+	m_oPtr(0U)
+	{
+		m_buffer = new T[length];
+
+		::memset(m_buffer, 0x00, m_length * sizeof(T));
+	}
+
+	~CBaselineRingBuffer()
+	{
+		delete[] m_buffer;
+	}
+
+	bool addData(const T* buffer, unsigned int nSamples)
+	{
+		if (nSamples >= freeSpace()) {
+			clear();
+			return false;
+		}
+
+		for (unsigned int i = 0U; i < nSamples; i++) {
+			m_buffer[m_iPtr++] = buffer[i];
+
+			if (m_iPtr == m_length)
+				m_iPtr = 0U;
+		}
+
+		return true;
+	}
+
+	bool getData(T* buffer, unsigned int nSamples)
+	{
+		if (dataSize() < nSamples)
+			return false;
+
+		for (unsigned int i = 0U; i < nSamples; i++) {
+			buffer[i] = m_buffer[m_oPtr++];
+
+			if (m_oPtr == m_length)
+				m_oPtr = 0U;
+		}
+
+		return true;
+	}
+
+	void clear()
+	{
+		m_iPtr = 0U;
+		m_oPtr = 0U;
+
+		::memset(m_buffer, 0x00, m_length * sizeof(T));
+	}
+
+	unsigned int freeSpace() const
+	{
+		unsigned int len = m_length;
+
+		if (m_oPtr > m_iPtr)
+			len = m_oPtr - m_iPtr;
+		else if (m_iPtr > m_oPtr)
+			len = m_length - (m_iPtr - m_oPtr);
+
+		if (len > m_length)
+			len = 0U;
+
+		return len;
+	}
+
+	unsigned int dataSize() const
+	{
+		return m_length - freeSpace();
+	}
+
+private:
+	unsigned int m_length;
+	T*           m_buffer;
+	unsigned int m_iPtr;
+	unsigned int m_oPtr;
+};
+
+// Random sized writes and reads through both rings, which must give back the same bytes
+static bool compare()
+{
+	CRingBuffer<unsigned char> ring(RING_LENGTH, "new");
+	CBaselineRingBuffer<unsigned char> baseline(RING_LENGTH, "baseline");
+
+	unsigned char in[200U], out1[200U], out2[200U];
+	unsigned int seed = 1U;
+	unsigned int fill = 0U;
+
+	for (unsigned int i = 0U; i < 2000000U; i++) {
+		seed = seed * 1103515245U + 12345U;
+		unsigned int n = (seed >> 16) % 200U + 1U;
+
+		if ((seed & 0x100U) == 0x100U) {
+			if (fill + n < RING_LENGTH - 1U) {
+				for (unsigned int j = 0U; j < n; j++)
+					in[j] = seed + j;
+
+				ring.addData(in, n);
+				baseline.addData(in, n);
+				fill += n;
+			}
+		} else if (fill >= n) {
+			ring.getData(out1, n);
+			baseline.getData(out2, n);
+			fill -= n;
+
+			if (::memcmp(out1, out2, n) != 0)
+				return false;
+		}
+
+		if (ring.dataSize() != baseline.dataSize())
+			return false;
+	}
+
+	return true;
+}
+
+// Queues a frame every time round and drains two every other time, so the ring stays part full
+// and the copies wrap as they do in use. Returns the nanoseconds for each frame in and out.
+template<class R> static double measure(unsigned int length)
+{
+	R ring(RING_LENGTH, "bench");
+
+	unsigned char in[255U], out[255U];
+	for (unsigned int i = 0U; i < length; i++)
+		in[i] = i;
+
+	unsigned long long timestamp = 0ULL;
+	unsigned int sum = 0U;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0U; i < ITERATIONS; i++) {
+		unsigned char len = length;
+		ring.addData(&len, 1U);
+		ring.addData((unsigned char*)&timestamp, sizeof(unsigned long long));
+		ring.addData(in, len);
+
+		if ((i & 0x01U) == 0x01U) {
+			for (unsigned int j = 0U; j < 2U; j++) {
+				ring.getData(&len, 1U);
+				ring.getData((unsigned char*)&timestamp, sizeof(unsigned long long));
+				ring.getData(out, len);
+				sum += out[len - 1U];
+			}
+		}
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	// Keeps the copies from being optimised away
+	if (sum == 1U)
+		::fprintf(stderr, "%u\n", sum);
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+int main()
+{
+	if (!compare()) {
+		::fprintf(stderr, "CRingBuffer: the output differs from the baseline ring\n");
+		return 1;
+	}
+
+	static const unsigned int LENGTHS[] = {33U, 55U, 71U};
+
+	for (unsigned int i = 0U; i < 3U; i++) {
+		double before = measure< CBaselineRingBuffer<unsigned char> >(LENGTHS[i]);
+		double after  = measure< CRingBuffer<unsigned char> >(LENGTHS[i]);
+
+		::fprintf(stdout, "CRingBuffer: %u byte frames, %.1f ns per frame before, %.1f ns after\n", LENGTHS[i], before, after);
+	}
+
+	return 0;
+}
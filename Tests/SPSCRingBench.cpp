@@ -0,0 +1,128 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Times CSPSCRing passing network packets from a producer thread to a consumer thread, an item
+// at a time and in batches. Run it with "make bench".
+
+#include "NetworkPacket.h"
+#include "SPSCRing.h"
+#include "Thread.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include <sched.h>
+
+const unsigned long long ITEMS = 4000000ULL;
+const unsigned int RING_LENGTH = 64U;
+const unsigned int MAX_BATCH   = 16U;
+
+class CProducer : public CThread {
+public:
+	CProducer(CSPSCRing<CNetworkPacket>& ring, unsigned int batch) :
+	m_ring(ring),
+	m_batch(batch)
+	{
+	}
+
+	virtual void entry()
+	{
+		CNetworkPacket packets[MAX_BATCH];
+		for (unsigned int i = 0U; i < MAX_BATCH; i++) {
+			packets[i].m_length    = 55U;
+			packets[i].m_timestamp = 0ULL;
+		}
+
+		unsigned long long n = 0ULL;
+		while (n < ITEMS) {
+			unsigned int count = m_batch;
+			if (count > ITEMS - n)
+				count = (unsigned int)(ITEMS - n);
+
+			unsigned int pushed = m_ring.push(packets, count);
+			if (pushed == 0U)
+				::sched_yield();
+
+			n += pushed;
+		}
+	}
+
+private:
+	CSPSCRing<CNetworkPacket>& m_ring;
+	unsigned int               m_batch;
+};
+
+class CConsumer : public CThread {
+public:
+	CConsumer(CSPSCRing<CNetworkPacket>& ring, unsigned int batch) :
+	m_ring(ring),
+	m_batch(batch)
+	{
+	}
+
+	virtual void entry()
+	{
+		CNetworkPacket packets[MAX_BATCH];
+
+		unsigned long long n = 0ULL;
+		while (n < ITEMS) {
+			unsigned int count = m_ring.pop(packets, m_batch);
+			if (count == 0U)
+				::sched_yield();
+
+			n += count;
+		}
+	}
+
+private:
+	CSPSCRing<CNetworkPacket>& m_ring;
+	unsigned int               m_batch;
+};
+
+// Returns the nanoseconds for each packet to go through the ring
+static double measure(unsigned int batch)
+{
+	CSPSCRing<CNetworkPacket> ring(RING_LENGTH, "bench");
+
+	CProducer producer(ring, batch);
+	CConsumer consumer(ring, batch);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	consumer.run();
+	producer.run();
+
+	producer.wait();
+	consumer.wait();
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / ITEMS;
+}
+
+int main()
+{
+	for (unsigned int i = 0U; i < 3U; i++) {
+		double single = measure(1U);
+		double batch  = measure(MAX_BATCH);
+
+		::fprintf(stdout, "CSPSCRing: %.1f ns per packet one at a time, %.1f ns in batches of %u\n", single, batch, MAX_BATCH);
+	}
+
+	return 0;
+}
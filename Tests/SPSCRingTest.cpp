@@ -0,0 +1,188 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Checks CSPSCRing on its own and with a producer and a consumer thread. Run it with "make check".
+
+#include "NetworkPacket.h"
+#include "SPSCRing.h"
+#include "Thread.h"
+
+#include <cstdio>
+
+#include <sched.h>
+
+const unsigned long long ITEMS = 1000000ULL;
+
+static void fill(CNetworkPacket& packet, unsigned long long n)
+{
+	packet.m_timestamp = n;
+	packet.m_length    = (unsigned int)(n % NETWORK_PACKET_LENGTH);
+	packet.m_data[0U]  = (unsigned char)n;
+	packet.m_data[NETWORK_PACKET_LENGTH - 1U] = (unsigned char)(n >> 8);
+}
+
+static bool valid(const CNetworkPacket& packet, unsigned long long n)
+{
+	return packet.m_timestamp == n &&
+		packet.m_length == (unsigned int)(n % NETWORK_PACKET_LENGTH) &&
+		packet.m_data[0U] == (unsigned char)n &&
+		packet.m_data[NETWORK_PACKET_LENGTH - 1U] == (unsigned char)(n >> 8);
+}
+
+// Pushes the sequence in batches of one to seven, retrying whatever did not fit. Giving up the
+// processor when the ring is full or empty lets the test finish on a single core.
+class CProducer : public CThread {
+public:
+	CProducer(CSPSCRing<CNetworkPacket>& ring) :
+	m_ring(ring)
+	{
+	}
+
+	virtual void entry()
+	{
+		CNetworkPacket packets[7U];
+
+		unsigned long long n = 0ULL;
+		while (n < ITEMS) {
+			unsigned int count = (unsigned int)(n % 7ULL) + 1U;
+			if (count > ITEMS - n)
+				count = (unsigned int)(ITEMS - n);
+
+			for (unsigned int i = 0U; i < count; i++)
+				fill(packets[i], n + i);
+
+			unsigned int pushed = m_ring.push(packets, count);
+			if (pushed == 0U)
+				::sched_yield();
+
+			n += pushed;
+		}
+	}
+
+private:
+	CSPSCRing<CNetworkPacket>& m_ring;
+};
+
+// Pops in batches of one to five and checks every packet arrives once and in order
+class CConsumer : public CThread {
+public:
+	CConsumer(CSPSCRing<CNetworkPacket>& ring) :
+	m_ring(ring),
+	m_errors(0U)
+	{
+	}
+
+	virtual void entry()
+	{
+		CNetworkPacket packets[5U];
+
+		unsigned long long n = 0ULL;
+		while (n < ITEMS) {
+			unsigned int count = m_ring.pop(packets, (unsigned int)(n % 5ULL) + 1U);
+			if (count == 0U)
+				::sched_yield();
+
+			for (unsigned int i = 0U; i < count; i++, n++) {
+				if (!valid(packets[i], n))
+					m_errors++;
+			}
+		}
+	}
+
+	unsigned int getErrors() const
+	{
+		return m_errors;
+	}
+
+private:
+	CSPSCRing<CNetworkPacket>& m_ring;
+	unsigned int               m_errors;
+};
+
+static bool testSingleThread()
+{
+	CSPSCRing<unsigned int> ring(4U, "single");
+
+	unsigned int in[4U] = {1U, 2U, 3U, 4U};
+	unsigned int out[4U];
+
+	// One slot is always left empty, so only three fit and the fourth is dropped
+	if (!ring.isEmpty() || ring.space() != 3U)
+		return false;
+	if (ring.push(in, 4U) != 3U || ring.getDropped() != 1U || ring.depth() != 3U || ring.space() != 0U)
+		return false;
+	if (ring.push(in[3U]))
+		return false;
+
+	if (ring.pop(out, 2U) != 2U || out[0U] != 1U || out[1U] != 2U)
+		return false;
+
+	// Wraps round the end of the buffer
+	if (ring.push(in, 2U) != 2U || ring.depth() != 3U)
+		return false;
+	if (ring.pop(out, 4U) != 3U || out[0U] != 3U || out[1U] != 1U || out[2U] != 2U)
+		return false;
+	if (!ring.isEmpty() || ring.pop(out[0U]))
+		return false;
+
+	if (ring.getMaxDepth() != 3U || ring.getMaxDepth() != 0U)
+		return false;
+
+	return true;
+}
+
+static bool testTwoThreads(unsigned int length)
+{
+	CSPSCRing<CNetworkPacket> ring(length, "two threads");
+
+	CProducer producer(ring);
+	CConsumer consumer(ring);
+
+	consumer.run();
+	producer.run();
+
+	producer.wait();
+	consumer.wait();
+
+	return consumer.getErrors() == 0U && ring.isEmpty();
+}
+
+int main()
+{
+	bool ok = true;
+
+	if (!testSingleThread()) {
+		::fprintf(stderr, "CSPSCRing: the single thread checks failed\n");
+		ok = false;
+	}
+
+	// A short ring is full or empty most of the time, a longer one mostly part full
+	static const unsigned int LENGTHS[] = {2U, 8U, 64U};
+
+	for (unsigned int i = 0U; i < 3U; i++) {
+		if (!testTwoThreads(LENGTHS[i])) {
+			::fprintf(stderr, "CSPSCRing: packets were lost, repeated or reordered with a ring of %u\n", LENGTHS[i]);
+			ok = false;
+		}
+	}
+
+	if (ok)
+		::fprintf(stdout, "CSPSCRing: all checks passed\n");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+// Times CUDPSocket on the loopback interface with 55 byte packets, the size of a DMRD packet.
+// The receive test has a second thread sending as fast as it can while this one waits on a
+// CPoller and reads in batches, and the send test queues and flushes batches and reads them
+// back. Each gives the packets per second and the CPU time of the measuring thread for each
+// packet. Run it with "make bench", and build it with io_uring with "make bench-io_uring"
+// to compare the two. Linux only.
+
+#include "UDPSocket.h"
+#include "Poller.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/resource.h>
+
+const unsigned short RX_PORT = 46000U;
+const unsigned short TX_PORT = 46001U;
+
+const unsigned int PACKET_LENGTH = 55U;
+const unsigned int BUFFER_LENGTH = 256U;
+const unsigned int RX_BATCH      = 16U;
+const unsigned int TX_BATCH      = 32U;
+
+const double RUN_TIME = 3.0;
+
+#if defined(USE_IO_URING)
+const char* BACKEND = "io_uring";
+#else
+const char* BACKEND = "recvmmsg/sendmmsg";
+#endif
+
+// Returns the CPU time, user and system, used by the calling thread in seconds
+static double threadTime()
+{
+	struct rusage usage;
+	::getrusage(RUSAGE_THREAD, &usage);
+
+	return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+class CSender : public CThread {
+public:
+	CSender(const sockaddr_storage& address, unsigned int addressLength) :
+	m_address(address),
+	m_addressLength(addressLength),
+	m_running(true)
+	{
+	}
+
+	virtual void entry()
+	{
+		CUDPSocket socket;
+		if (!socket.open())
+			return;
+
+		unsigned char packet[PACKET_LENGTH];
+		::memset(packet, 0x00U, PACKET_LENGTH);
+
+		while (m_running) {
+			for (unsigned int i = 0U; i < TX_BATCH; i++)
+				socket.queue(packet, PACKET_LENGTH, m_address, m_addressLength);
+
+			socket.flush();
+		}
+
+		socket.close();
+	}
+
+	void stop()
+	{
+		m_running = false;
+	}
+
+private:
+	sockaddr_storage  m_address;
+	unsigned int      m_addressLength;
+	std::atomic<bool> m_running;
+};
+
+static void measureReceive()
+{
+	sockaddr_storage address;
+	unsigned int addressLength;
+	if (CUDPSocket::lookup("127.0.0.1", RX_PORT, address, addressLength) != 0)
+		return;
+
+	CPoller poller;
+	if (!poller.open())
+		return;
+
+	CUDPSocket socket("127.0.0.1", RX_PORT);
+	socket.setPoller(&poller);
+	if (!socket.open()) {
+		poller.close();
+		return;
+	}
+
+	unsigned char buffer[RX_BATCH * BUFFER_LENGTH];
+	unsigned int lengths[RX_BATCH];
+	sockaddr_storage addresses[RX_BATCH];
+
+	CSender sender(address, addressLength);
+	sender.run();
+
+	unsigned long long packets = 0ULL;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double cpu = threadTime();
+
+	for (;;) {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= RUN_TIME)
+			break;
+
+		poller.wait(10U);
+
+		int count;
+		while ((count = socket.read(buffer, BUFFER_LENGTH, RX_BATCH, lengths, addresses)) > 0)
+			packets += count;
+	}
+
+	cpu = threadTime() - cpu;
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	sender.stop();
+	sender.wait();
+
+	socket.close();
+	poller.close();
+
+	if (packets == 0ULL) {
+		::fprintf(stdout, "CUDPSocket (%s): no packets received\n", BACKEND);
+		return;
+	}
+
+	::fprintf(stdout, "CUDPSocket (%s): receive %.0f packets/s, %.0f ns CPU per packet\n", BACKEND, double(packets) / elapsed, cpu * 1000000000.0 / double(packets));
+}
+
+static void measureSend()
+{
+	sockaddr_storage address;
+	unsigned int addressLength;
+	if (CUDPSocket::lookup("127.0.0.1", TX_PORT, address, addressLength) != 0)
+		return;
+
+	CUDPSocket receiver("127.0.0.1", TX_PORT);
+	if (!receiver.open())
+		return;
+
+	CUDPSocket sender;
+	if (!sender.open()) {
+		receiver.close();
+		return;
+	}
+
+	unsigned char packet[PACKET_LENGTH];
+	::memset(packet, 0x00U, PACKET_LENGTH);
+
+	unsigned char buffer[RX_BATCH * BUFFER_LENGTH];
+	unsigned int lengths[RX_BATCH];
+	sockaddr_storage addresses[RX_BATCH];
+
+	unsigned long long packets = 0ULL;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double cpu = threadTime();
+
+	for (;;) {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= RUN_TIME)
+			break;
+
+		for (unsigned int i = 0U; i < TX_BATCH; i++)
+			sender.queue(packet, PACKET_LENGTH, address, addressLength);
+
+		sender.flush();
+		packets += TX_BATCH;
+
+		while (receiver.read(buffer, BUFFER_LENGTH, RX_BATCH, lengths, addresses) > 0)
+			;
+	}
+
+	cpu = threadTime() - cpu;
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	sender.close();
+	receiver.close();
+
+	::fprintf(stdout, "CUDPSocket (%s): send and receive %.0f packets/s, %.0f ns CPU per packet\n", BACKEND, double(packets) / elapsed, cpu * 1000000000.0 / double(packets));
+}
+
+int main()
+{
+	measureReceive();
+	measureSend();
+
+	return 0;
+}
@@ -0,0 +1,315 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+// Compares the two transports for the MMDVM Host link, loopback UDP and a Unix domain socket,
+// with CUDPSocket at both ends and 55 byte packets, the size of a DMRD packet. The round trip
+// test bounces one packet at a time off a second thread, and the one way test has a second
+// thread send in batches of 8 as fast as it can and counts how many arrive. Run it with
+// "make bench". Linux only.
+
+#include "UDPSocket.h"
+#include "Poller.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+const unsigned short GATEWAY_PORT  = 46010U;
+const unsigned short REPEATER_PORT = 46011U;
+
+const char* GATEWAY_PATH  = "/tmp/UnixSocketBench-gw.sock";
+const char* REPEATER_PATH = "/tmp/UnixSocketBench-rpt.sock";
+
+const unsigned int PACKET_LENGTH = 55U;
+const unsigned int BUFFER_LENGTH = 256U;
+const unsigned int RX_BATCH      = 16U;
+const unsigned int TX_BATCH      = 8U;
+
+const unsigned int ROUND_TRIPS = 20000U;
+const unsigned int ONE_WAY     = 400000U;
+
+// The two ends of the link, a gateway and a repeater, over one transport
+struct CLink {
+	CLink(bool isUnix) :
+	m_unix(isUnix),
+	m_gateway(isUnix ? std::string(GATEWAY_PATH) : std::string("127.0.0.1"), isUnix ? 0U : GATEWAY_PORT),
+	m_repeater(isUnix ? std::string(REPEATER_PATH) : std::string("127.0.0.1"), isUnix ? 0U : REPEATER_PORT),
+	m_gatewayAddr(),
+	m_gatewayAddrLen(0U),
+	m_repeaterAddr(),
+	m_repeaterAddrLen(0U)
+	{
+	}
+
+	bool open()
+	{
+		if (m_unix) {
+			if (CUDPSocket::lookupUnix(GATEWAY_PATH, m_gatewayAddr, m_gatewayAddrLen) != 0)
+				return false;
+			if (CUDPSocket::lookupUnix(REPEATER_PATH, m_repeaterAddr, m_repeaterAddrLen) != 0)
+				return false;
+		} else {
+			if (CUDPSocket::lookup("127.0.0.1", GATEWAY_PORT, m_gatewayAddr, m_gatewayAddrLen) != 0)
+				return false;
+			if (CUDPSocket::lookup("127.0.0.1", REPEATER_PORT, m_repeaterAddr, m_repeaterAddrLen) != 0)
+				return false;
+		}
+
+		if (!m_gateway.open(m_gatewayAddr))
+			return false;
+
+		if (!m_repeater.open(m_repeaterAddr)) {
+			m_gateway.close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close()
+	{
+		m_gateway.close();
+		m_repeater.close();
+	}
+
+	const char* getName() const
+	{
+		return m_unix ? "Unix" : "UDP";
+	}
+
+	bool             m_unix;
+	CUDPSocket       m_gateway;
+	CUDPSocket       m_repeater;
+	sockaddr_storage m_gatewayAddr;
+	unsigned int     m_gatewayAddrLen;
+	sockaddr_storage m_repeaterAddr;
+	unsigned int     m_repeaterAddrLen;
+};
+
+// Sends back every packet that the repeater end receives
+class CEcho : public CThread {
+public:
+	CEcho(CLink& link) :
+	m_link(link),
+	m_running(true)
+	{
+	}
+
+	virtual void entry()
+	{
+		CPoller poller;
+		if (!poller.open())
+			return;
+
+		m_link.m_repeater.setPoller(&poller);
+		m_link.m_repeater.setPolling(true);
+
+		unsigned char buffer[BUFFER_LENGTH];
+		sockaddr_storage address;
+		unsigned int addressLength;
+
+		while (m_running) {
+			poller.wait(10U);
+
+			int length;
+			while ((length = m_link.m_repeater.read(buffer, BUFFER_LENGTH, address, addressLength)) > 0)
+				m_link.m_repeater.write(buffer, length, m_link.m_gatewayAddr, m_link.m_gatewayAddrLen);
+		}
+
+		m_link.m_repeater.setPolling(false);
+		m_link.m_repeater.setPoller(nullptr);
+
+		poller.close();
+	}
+
+	void stop()
+	{
+		m_running = false;
+	}
+
+private:
+	CLink&            m_link;
+	std::atomic<bool> m_running;
+};
+
+// Sends packets from the gateway end to the repeater end in batches, as fast as it can
+class CBlaster : public CThread {
+public:
+	CBlaster(CLink& link) :
+	m_link(link),
+	m_done(false)
+	{
+	}
+
+	virtual void entry()
+	{
+		unsigned char packet[PACKET_LENGTH];
+		::memset(packet, 0x00U, PACKET_LENGTH);
+
+		for (unsigned int n = 0U; n < ONE_WAY; n += TX_BATCH) {
+			for (unsigned int i = 0U; i < TX_BATCH; i++)
+				m_link.m_gateway.queue(packet, PACKET_LENGTH, m_link.m_repeaterAddr, m_link.m_repeaterAddrLen);
+
+			m_link.m_gateway.flush();
+		}
+
+		m_done = true;
+	}
+
+	bool isDone() const
+	{
+		return m_done;
+	}
+
+private:
+	CLink&            m_link;
+	std::atomic<bool> m_done;
+};
+
+static void measureRoundTrip(bool isUnix)
+{
+	CLink link(isUnix);
+	if (!link.open())
+		return;
+
+	CPoller poller;
+	if (!poller.open()) {
+		link.close();
+		return;
+	}
+
+	link.m_gateway.setPoller(&poller);
+	link.m_gateway.setPolling(true);
+
+	CEcho echo(link);
+	echo.run();
+
+	unsigned char packet[PACKET_LENGTH];
+	::memset(packet, 0x00U, PACKET_LENGTH);
+
+	unsigned char buffer[BUFFER_LENGTH];
+	sockaddr_storage address;
+	unsigned int addressLength;
+
+	unsigned int lost = 0U;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (unsigned int n = 0U; n < ROUND_TRIPS; n++) {
+		link.m_gateway.write(packet, PACKET_LENGTH, link.m_repeaterAddr, link.m_repeaterAddrLen);
+
+		// A packet that hasn't come back in a second isn't going to
+		int length = link.m_gateway.read(buffer, BUFFER_LENGTH, address, addressLength);
+		for (unsigned int i = 0U; i < 100U && length == 0; i++) {
+			poller.wait(10U);
+			length = link.m_gateway.read(buffer, BUFFER_LENGTH, address, addressLength);
+		}
+
+		if (length <= 0)
+			lost++;
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	echo.stop();
+	echo.wait();
+
+	link.m_gateway.setPolling(false);
+	link.m_gateway.setPoller(nullptr);
+	poller.close();
+	link.close();
+
+	double us = std::chrono::duration<double, std::micro>(end - start).count() / ROUND_TRIPS;
+
+	::fprintf(stdout, "%s: %.1f us per round trip, %u of %u lost\n", link.getName(), us, lost, ROUND_TRIPS);
+}
+
+static void measureOneWay(bool isUnix)
+{
+	CLink link(isUnix);
+	if (!link.open())
+		return;
+
+	CPoller poller;
+	if (!poller.open()) {
+		link.close();
+		return;
+	}
+
+	link.m_repeater.setPoller(&poller);
+	link.m_repeater.setPolling(true);
+
+	unsigned char buffer[RX_BATCH * BUFFER_LENGTH];
+	unsigned int lengths[RX_BATCH];
+	sockaddr_storage addresses[RX_BATCH];
+
+	unsigned int received = 0U;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point end   = start;
+
+	CBlaster blaster(link);
+	blaster.run();
+
+	// Once the sender has finished, anything not read within 100ms was dropped
+	unsigned int idle = 0U;
+	while (idle < 10U) {
+		poller.wait(10U);
+
+		int count;
+		bool any = false;
+		while ((count = link.m_repeater.read(buffer, BUFFER_LENGTH, RX_BATCH, lengths, addresses)) > 0) {
+			received += count;
+			end = std::chrono::steady_clock::now();
+			any = true;
+		}
+
+		if (blaster.isDone() && !any)
+			idle++;
+	}
+
+	blaster.wait();
+
+	link.m_repeater.setPolling(false);
+	link.m_repeater.setPoller(nullptr);
+	poller.close();
+	link.close();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	::fprintf(stdout, "%s: %u of %u packets received one way (%.0f%%), %.0f packets/s\n", link.getName(), received, ONE_WAY, 100.0 * double(received) / double(ONE_WAY), seconds > 0.0 ? double(received) / seconds : 0.0);
+}
+
+int main()
+{
+	for (unsigned int i = 0U; i < 3U; i++) {
+		measureRoundTrip(false);
+		measureRoundTrip(true);
+	}
+
+	for (unsigned int i = 0U; i < 3U; i++) {
+		measureOneWay(false);
+		measureOneWay(true);
+	}
+
+	return 0;
+}
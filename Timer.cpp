@@ -24,45 +24,90 @@
 CTimer::CTimer(unsigned int ticksPerSec, unsigned int secs, unsigned int msecs) :
 m_ticksPerSec(ticksPerSec),
 m_timeout(0U),
-m_timer(0U)
+m_running(false),
+m_start(0ULL),
+m_deadline(0ULL),
+m_entry(),
+m_callback(nullptr),
+m_param(nullptr)
 {
 	assert(ticksPerSec > 0U);
 
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	}
+	m_timeout = secs * 1000U + msecs;
 }
 
 CTimer::~CTimer()
 {
+	stop();
 }
 
 void CTimer::setTimeout(unsigned int secs, unsigned int msecs)
 {
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	} else {
-		m_timeout = 0U;
-		m_timer = 0U;
+	m_timeout = secs * 1000U + msecs;
+
+	if (m_timeout == 0U) {
+		stop();
+	} else if (m_running) {
+		CTimerService::remove(m_entry);
+		schedule();
 	}
 }
 
 unsigned int CTimer::getTimeout() const
 {
-	if (m_timeout == 0U)
+	return m_timeout / 1000U;
+}
+
+unsigned int CTimer::getTimer() const
+{
+	if (!m_running)
 		return 0U;
 
-	return (m_timeout - 1U) / m_ticksPerSec;
+	return (unsigned int)((CTimerService::now() - m_start) / 1000ULL);
 }
 
-unsigned int CTimer::getTimer() const
+unsigned int CTimer::getRemaining()
 {
-	if (m_timer == 0U)
+	if (!m_running)
+		return 0U;
+
+	unsigned long long now = CTimerService::now();
+	if (now >= m_deadline)
 		return 0U;
 
-	return (m_timer - 1U) / m_ticksPerSec;
+	return (unsigned int)((m_deadline - now) / 1000ULL);
+}
+
+void CTimer::start()
+{
+	if (m_timeout == 0U)
+		return;
+
+	if (m_running)
+		CTimerService::remove(m_entry);
+
+	m_start = CTimerService::now();
+	schedule();
+}
+
+void CTimer::stop()
+{
+	if (!m_running)
+		return;
+
+	CTimerService::remove(m_entry);
+	m_running = false;
+}
+
+void CTimer::setCallback(void (*callback)(void* param), void* param)
+{
+	m_callback = callback;
+	m_param    = param;
+}
+
+void CTimer::schedule()
+{
+	m_deadline = m_start + m_timeout;
+	m_entry    = CTimerService::add(m_deadline, this);
+	m_running  = true;
 }
@@ -19,6 +19,10 @@
 #ifndef	Timer_H
 #define	Timer_H
 
+#include "TimerService.h"
+
+// A thin adapter over CTimerService. Running timers hold an absolute deadline rather than counting
+// ticks, so clock() is kept only for compatibility and does nothing.
 class CTimer {
 public:
 	CTimer(unsigned int ticksPerSec, unsigned int secs = 0U, unsigned int msecs = 0U);
@@ -29,20 +33,11 @@ public:
 	unsigned int getTimeout() const;
 	unsigned int getTimer() const;
 
-	unsigned int getRemaining()
-	{
-		if (m_timeout == 0U || m_timer == 0U)
-			return 0U;
-
-		if (m_timer >= m_timeout)
-			return 0U;
-
-		return (m_timeout - m_timer) / m_ticksPerSec;
-	}
+	unsigned int getRemaining();
 
 	bool isRunning()
 	{
-		return m_timer > 0U;
+		return m_running;
 	}
 
 	void start(unsigned int secs, unsigned int msecs = 0U)
@@ -52,38 +47,45 @@ public:
 		start();
 	}
 
-	void start()
-	{
-		if (m_timeout > 0U)
-			m_timer = 1U;
-	}
+	void start();
 
-	void stop()
-	{
-		m_timer = 0U;
-	}
+	void stop();
 
 	bool hasExpired()
 	{
-		if (m_timeout == 0U || m_timer == 0U)
+		if (!m_running)
 			return false;
 
-		if (m_timer >= m_timeout)
-			return true;
+		return CTimerService::time() >= m_deadline;
+	}
 
-		return false;
+	void clock(unsigned int = 1U)
+	{
+	}
+
+	void setCallback(void (*callback)(void* param), void* param);
+
+	bool hasCallback() const
+	{
+		return m_callback != nullptr;
 	}
 
-	void clock(unsigned int ticks = 1U)
+	void callback()
 	{
-		if (m_timer > 0U && m_timeout > 0U)
-			m_timer += ticks;
+		m_callback(m_param);
 	}
 
 private:
-	unsigned int m_ticksPerSec;
-	unsigned int m_timeout;
-	unsigned int m_timer;
+	unsigned int       m_ticksPerSec;
+	unsigned int       m_timeout;
+	bool               m_running;
+	unsigned long long m_start;
+	unsigned long long m_deadline;
+	TimerEntry         m_entry;
+	void             (*m_callback)(void* param);
+	void*              m_param;
+
+	void schedule();
 };
 
 #endif
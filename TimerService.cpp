@@ -0,0 +1,93 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "TimerService.h"
+#include "Timer.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+thread_local unsigned long long   CTimerService::m_time = 0ULL;
+thread_local TimerMap             CTimerService::m_deadlines;
+thread_local std::vector<CTimer*> CTimerService::m_expired;
+
+void CTimerService::clock()
+{
+	m_time = now();
+
+	// Timers with a callback are one-shot, the callback restarts them if it wants to
+	m_expired.clear();
+	for (TimerEntry it = m_deadlines.begin(); it != m_deadlines.end() && it->first <= m_time; ++it) {
+		if (it->second->hasCallback())
+			m_expired.push_back(it->second);
+	}
+
+	for (std::vector<CTimer*>::iterator it = m_expired.begin(); it != m_expired.end(); ++it) {
+		(*it)->stop();
+		(*it)->callback();
+	}
+}
+
+unsigned long long CTimerService::time()
+{
+	return m_time;
+}
+
+unsigned long long CTimerService::now()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return ::GetTickCount64();
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000ULL + now.tv_nsec / 1000000ULL;
+#endif
+}
+
+// Deadlines at or before the last clock() have already been seen by this pass of the main loop,
+// so only the first one after it matters.
+unsigned int CTimerService::getNextExpiry(unsigned int max)
+{
+	TimerEntry it = m_deadlines.upper_bound(m_time);
+	if (it == m_deadlines.end())
+		return max;
+
+	unsigned long long current = now();
+	if (it->first <= current)
+		return 0U;
+
+	unsigned long long remaining = it->first - current;
+	if (remaining > max)
+		return max;
+
+	return (unsigned int)remaining;
+}
+
+TimerEntry CTimerService::add(unsigned long long deadline, CTimer* timer)
+{
+	return m_deadlines.insert(std::make_pair(deadline, timer));
+}
+
+void CTimerService::remove(TimerEntry entry)
+{
+	m_deadlines.erase(entry);
+}
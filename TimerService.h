@@ -0,0 +1,118 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TimerService_H)
+#define	TimerService_H
+
+#include <cstddef>
+#include <map>
+#include <new>
+#include <vector>
+
+class CTimer;
+
+// Keeps the nodes of a thread's deadline map on a free list when a timer stops, so restarting a
+// timer, which happens for every frame forwarded, never reaches the heap once the busiest set of
+// timers has been seen.
+template <class T>
+class CTimerNodeAllocator {
+public:
+	typedef T value_type;
+
+	CTimerNodeAllocator()
+	{
+	}
+
+	template <class U>
+	CTimerNodeAllocator(const CTimerNodeAllocator<U>&)
+	{
+	}
+
+	T* allocate(std::size_t n)
+	{
+		if (n == 1U && m_free != nullptr) {
+			FreeNode* node = m_free;
+			m_free = node->m_next;
+			return reinterpret_cast<T*>(node);
+		}
+
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, std::size_t n)
+	{
+		if (n == 1U && sizeof(T) >= sizeof(FreeNode)) {
+			FreeNode* node = reinterpret_cast<FreeNode*>(p);
+			node->m_next = m_free;
+			m_free = node;
+			return;
+		}
+
+		::operator delete(p);
+	}
+
+	template <class U>
+	bool operator==(const CTimerNodeAllocator<U>&) const
+	{
+		return true;
+	}
+
+	template <class U>
+	bool operator!=(const CTimerNodeAllocator<U>&) const
+	{
+		return false;
+	}
+
+private:
+	struct FreeNode {
+		FreeNode* m_next;
+	};
+
+	static thread_local FreeNode* m_free;
+};
+
+template <class T>
+thread_local typename CTimerNodeAllocator<T>::FreeNode* CTimerNodeAllocator<T>::m_free = nullptr;
+
+typedef std::multimap<unsigned long long, CTimer*, std::less<unsigned long long>, CTimerNodeAllocator<std::pair<const unsigned long long, CTimer*> > > TimerMap;
+
+typedef TimerMap::iterator TimerEntry;
+
+// Holds the absolute deadline, in monotonic milliseconds, of every running CTimer in expiry order.
+// The main loop latches the time once per pass with clock(), which also fires any timer callbacks
+// that have fallen due, and asks getNextExpiry() how long it may sleep for. Each thread has its own
+// set, so a timer must only ever be started and stopped from the thread that runs it.
+class CTimerService {
+public:
+	static void clock();
+
+	static unsigned long long time();
+	static unsigned long long now();
+
+	static unsigned int getNextExpiry(unsigned int max);
+
+	static TimerEntry add(unsigned long long deadline, CTimer* timer);
+	static void       remove(TimerEntry entry);
+
+private:
+	static thread_local unsigned long long   m_time;
+	static thread_local TimerMap             m_deadlines;
+	static thread_local std::vector<CTimer*> m_expired;
+};
+
+#endif
@@ -17,14 +17,28 @@
  */
 
 #include "UDPSocket.h"
+#include "IOURing.h"
+#include "Poller.h"
 
 #include <cassert>
 
 #if !defined(_WIN32) && !defined(_WIN64)
 #include <cerrno>
+#include <cstddef>
 #include <cstring>
 #endif
 
+#if defined(__linux__)
+const unsigned int MAX_BATCH_LENGTH = 32U;
+const unsigned int MAX_QUEUE_LENGTH = 32U;
+const unsigned int QUEUE_SLOT_LENGTH = 512U;
+const unsigned int CONTROL_LENGTH = CMSG_SPACE(sizeof(struct timespec));
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+const int UNIX_SEND_TIMEOUT = 20;	// ms
+#endif
+
 #if defined(HAVE_LOG_H)
 #include "Log.h"
 #else
@@ -41,7 +55,20 @@ m_fd(INVALID_SOCKET),
 #else
 m_fd(-1),
 #endif
-m_af(AF_UNSPEC)
+m_af(AF_UNSPEC),
+m_connected(false),
+#if defined(__linux__)
+m_txBuffer(nullptr),
+m_txLengths(nullptr),
+m_txAddresses(nullptr),
+m_txAddressLengths(nullptr),
+m_txCount(0U),
+#endif
+#if defined(USE_IO_URING) && defined(__linux__)
+m_ring(nullptr),
+#endif
+m_poller(nullptr),
+m_polled(false)
 {
 }
 
@@ -53,12 +80,34 @@ m_fd(INVALID_SOCKET),
 #else
 m_fd(-1),
 #endif
-m_af(AF_UNSPEC)
+m_af(AF_UNSPEC),
+m_connected(false),
+#if defined(__linux__)
+m_txBuffer(nullptr),
+m_txLengths(nullptr),
+m_txAddresses(nullptr),
+m_txAddressLengths(nullptr),
+m_txCount(0U),
+#endif
+#if defined(USE_IO_URING) && defined(__linux__)
+m_ring(nullptr),
+#endif
+m_poller(nullptr),
+m_polled(false)
 {
 }
 
 CUDPSocket::~CUDPSocket()
 {
+#if defined(__linux__)
+	delete[] m_txBuffer;
+	delete[] m_txLengths;
+	delete[] m_txAddresses;
+	delete[] m_txAddressLengths;
+#endif
+#if defined(USE_IO_URING) && defined(__linux__)
+	delete m_ring;
+#endif
 }
 
 void CUDPSocket::startup()
@@ -114,6 +163,31 @@ int CUDPSocket::lookup(const std::string& hostname, unsigned short port, sockadd
 	return 0;
 }
 
+// Make the address of a Unix domain datagram socket, which is simply its path in the file system
+int CUDPSocket::lookupUnix(const std::string& path, sockaddr_storage& addr, unsigned int& address_length)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LogError("Unix domain sockets are not supported on Windows - %s", path.c_str());
+	return -1;
+#else
+	sockaddr_un* paddr = (sockaddr_un*)&addr;
+	::memset(&addr, 0x00U, sizeof(sockaddr_storage));
+
+	if (path.empty() || (path.length() >= sizeof(paddr->sun_path))) {
+		LogError("The Unix socket path is invalid - %s", path.c_str());
+		address_length = 0U;
+		return -1;
+	}
+
+	paddr->sun_family = AF_UNIX;
+	::strcpy(paddr->sun_path, path.c_str());
+
+	address_length = (unsigned int)(offsetof(sockaddr_un, sun_path) + path.length() + 1U);
+
+	return 0;
+#endif
+}
+
 bool CUDPSocket::match(const sockaddr_storage& addr1, const sockaddr_storage& addr2, IPMATCHTYPE type)
 {
 	if (addr1.ss_family != addr2.ss_family)
@@ -131,6 +205,10 @@ bool CUDPSocket::match(const sockaddr_storage& addr1, const sockaddr_storage& ad
 				in6_1 = (struct sockaddr_in6*)&addr1;
 				in6_2 = (struct sockaddr_in6*)&addr2;
 				return IN6_ARE_ADDR_EQUAL(&in6_1->sin6_addr, &in6_2->sin6_addr) && (in6_1->sin6_port == in6_2->sin6_port);
+#if !defined(_WIN32) && !defined(_WIN64)
+			case AF_UNIX:
+				return ::strcmp(((struct sockaddr_un*)&addr1)->sun_path, ((struct sockaddr_un*)&addr2)->sun_path) == 0;
+#endif
 			default:
 				return false;
 		}
@@ -146,6 +224,10 @@ bool CUDPSocket::match(const sockaddr_storage& addr1, const sockaddr_storage& ad
 				in6_1 = (struct sockaddr_in6*)&addr1;
 				in6_2 = (struct sockaddr_in6*)&addr2;
 				return IN6_ARE_ADDR_EQUAL(&in6_1->sin6_addr, &in6_2->sin6_addr);
+#if !defined(_WIN32) && !defined(_WIN64)
+			case AF_UNIX:
+				return ::strcmp(((struct sockaddr_un*)&addr1)->sun_path, ((struct sockaddr_un*)&addr2)->sun_path) == 0;
+#endif
 			default:
 				return false;
 		}
@@ -161,6 +243,82 @@ bool CUDPSocket::isNone(const sockaddr_storage& addr)
 	return ((addr.ss_family == AF_INET) && (in->sin_addr.s_addr == htonl(INADDR_NONE)));
 }
 
+void CUDPSocket::setPoller(CPoller* poller)
+{
+	m_poller = poller;
+}
+
+// Stop, or start again, the poller returning for the datagrams waiting on the socket. A reader with
+// nowhere to put them leaves them queued in the socket, where they would otherwise keep waking it.
+void CUDPSocket::setPolling(bool polling)
+{
+	if ((m_poller == nullptr) || (polling == m_polled))
+		return;
+
+#if defined(_WIN32) || defined(_WIN64)
+	if (m_fd == INVALID_SOCKET)
+		return;
+#else
+	if (m_fd == -1)
+		return;
+#endif
+
+	if (polling)
+		m_poller->add(getPollFd());
+	else
+		m_poller->remove(getPollFd());
+
+	m_polled = polling;
+}
+
+// With io_uring it is the ring's completions that are waited on, rather than the socket itself
+#if defined(_WIN32) || defined(_WIN64)
+SOCKET CUDPSocket::getPollFd() const
+#else
+int CUDPSocket::getPollFd() const
+#endif
+{
+#if defined(USE_IO_URING) && defined(__linux__)
+	if (m_ring != nullptr)
+		return m_ring->getFd();
+#endif
+
+	return m_fd;
+}
+
+// Fix the socket to the one remote address, the kernel then drops datagrams from anywhere else and
+// keeps the route, so the address given to the writes is ignored. May be called again to re-target it.
+bool CUDPSocket::connect(const sockaddr_storage& address, unsigned int addressLength)
+{
+	// The socket may have failed to open again after an error
+#if defined(_WIN32) || defined(_WIN64)
+	if (m_fd == INVALID_SOCKET)
+		return false;
+#else
+	if (m_fd == -1)
+		return false;
+#endif
+
+	if (::connect(m_fd, (sockaddr*)&address, addressLength) == -1) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot connect the UDP socket, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot connect the UDP socket, err: %d", errno);
+#endif
+		m_connected = false;
+		return false;
+	}
+
+	m_connected = true;
+
+	return true;
+}
+
+bool CUDPSocket::isConnected() const
+{
+	return m_connected;
+}
+
 bool CUDPSocket::open(const sockaddr_storage& address)
 {
 	m_af = address.ss_family;
@@ -180,6 +338,11 @@ bool CUDPSocket::open()
 	unsigned int addrlen;
 	struct addrinfo hints;
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_af == AF_UNIX)
+		return openUnix();
+#endif
+
 	::memset(&hints, 0, sizeof(hints));
 	hints.ai_flags  = AI_PASSIVE;
 	hints.ai_family = m_af;
@@ -228,6 +391,83 @@ bool CUDPSocket::open()
 		LogInfo("Opening UDP port on %hu", m_localPort);
 	}
 
+	return setup();
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// The local address is the path to bind to. A socket left behind by an earlier run would stop the
+// bind, so it is removed first.
+bool CUDPSocket::openUnix()
+{
+	sockaddr_storage addr;
+	unsigned int addrlen;
+	if (lookupUnix(m_localAddress, addr, addrlen) != 0)
+		return false;
+
+	m_fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (m_fd < 0) {
+		LogError("Cannot create the Unix socket, err: %d", errno);
+		return false;
+	}
+
+	::unlink(m_localAddress.c_str());
+
+	if (::bind(m_fd, (sockaddr*)&addr, addrlen) == -1) {
+		LogError("Cannot bind the Unix socket %s, err: %d", m_localAddress.c_str(), errno);
+		close();
+		return false;
+	}
+
+	// The peer only queues a few datagrams, so a send waits a little for it to catch up with a burst,
+	// but never for long
+	struct timeval timeout;
+	timeout.tv_sec  = 0;
+	timeout.tv_usec = UNIX_SEND_TIMEOUT * 1000;
+	if (::setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == -1)
+		LogError("Cannot set the Unix socket send timeout, err: %d", errno);
+
+	LogInfo("Opening Unix socket on %s", m_localAddress.c_str());
+
+	return setup();
+}
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Unlike UDP, a Unix socket reports a peer that isn't there, or isn't keeping up, to the sender.
+// The datagram is simply dropped, so the gateway is never held up by the MMDVM Host.
+bool CUDPSocket::isPeerMissing(int err) const
+{
+	if (m_af != AF_UNIX)
+		return false;
+
+	return (err == ENOENT) || (err == ECONNREFUSED) || (err == EAGAIN) || (err == EWOULDBLOCK);
+}
+#endif
+
+bool CUDPSocket::setup()
+{
+#if defined(__linux__)
+	// Have the kernel note when each datagram arrives, so the time spent in the gateway can be measured
+	int timestamps = 1;
+	if (::setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps)) == -1)
+		LogError("Cannot set the UDP timestamp option, err: %d", errno);
+#endif
+
+#if defined(USE_IO_URING) && defined(__linux__)
+	// Fall back to the ordinary system calls if the kernel can't support the ring. Its sends wait for
+	// room at the other end, which a Unix socket's peer may never make.
+	if (m_af != AF_UNIX) {
+		m_ring = new CIOURing;
+		if (!m_ring->open(m_fd)) {
+			LogMessage("Using recvmmsg/sendmmsg for the UDP port on %hu", m_localPort);
+			delete m_ring;
+			m_ring = nullptr;
+		}
+	}
+#endif
+
+	setPolling(true);
+
 	return true;
 }
 
@@ -244,6 +484,17 @@ int CUDPSocket::read(unsigned char* buffer, unsigned int length, sockaddr_storag
 		return 0;
 #endif
 
+#if defined(USE_IO_URING) && defined(__linux__)
+	if (m_ring != nullptr) {
+		unsigned int len;
+		int ret = m_ring->read(buffer, length, 1U, &len, &address, &addressLength);
+		if (ret <= 0)
+			return ret;
+
+		return int(len);
+	}
+#endif
+
 	// Check that the readfrom() won't block
 	struct pollfd pfd;
 	pfd.fd      = m_fd;
@@ -283,6 +534,10 @@ int CUDPSocket::read(unsigned char* buffer, unsigned int length, sockaddr_storag
 #if defined(_WIN32) || defined(_WIN64)
 		LogError("Error returned from recvfrom, err: %lu", ::GetLastError());
 #else
+		// A connected socket reports an unreachable peer, which isn't a fault of the socket
+		if (len == -1 && errno == ECONNREFUSED && m_connected)
+			return 0;
+
 		LogError("Error returned from recvfrom, err: %d", errno);
 
 		if (len == -1 && errno == ENOTSOCK) {
@@ -299,6 +554,111 @@ int CUDPSocket::read(unsigned char* buffer, unsigned int length, sockaddr_storag
 	return len;
 }
 
+#if defined(__linux__)
+static unsigned long long getTimestamp(struct msghdr* msg)
+{
+	for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS)) {
+			struct timespec ts;
+			::memcpy(&ts, CMSG_DATA(cmsg), sizeof(struct timespec));
+			return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+		}
+	}
+
+	return 0ULL;
+}
+#endif
+
+// Read every datagram waiting on the socket, up to count of them, in one go. Each datagram is
+// placed in its own length sized slot in buffer, and the number of datagrams read is returned.
+// The optional timestamps are when the kernel received each one, in wall clock nanoseconds, or
+// zero where that isn't known.
+int CUDPSocket::read(unsigned char* buffer, unsigned int length, unsigned int count, unsigned int* lengths, sockaddr_storage* addresses, unsigned long long* timestamps)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+	assert(count > 0U);
+	assert(lengths != nullptr);
+	assert(addresses != nullptr);
+
+#if defined(__linux__)
+	if (m_fd == -1)
+		return 0;
+
+#if defined(USE_IO_URING)
+	if (m_ring != nullptr)
+		return m_ring->read(buffer, length, count, lengths, addresses, nullptr, timestamps);
+#endif
+
+	if (count > MAX_BATCH_LENGTH)
+		count = MAX_BATCH_LENGTH;
+
+	struct mmsghdr msgs[MAX_BATCH_LENGTH];
+	struct iovec   iovecs[MAX_BATCH_LENGTH];
+	unsigned char  controls[MAX_BATCH_LENGTH][CONTROL_LENGTH];
+	::memset(msgs, 0x00U, count * sizeof(struct mmsghdr));
+
+	for (unsigned int i = 0U; i < count; i++) {
+		iovecs[i].iov_base = buffer + i * length;
+		iovecs[i].iov_len  = length;
+
+		msgs[i].msg_hdr.msg_name    = &addresses[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+		msgs[i].msg_hdr.msg_iov     = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen  = 1U;
+
+		if (timestamps != nullptr) {
+			msgs[i].msg_hdr.msg_control    = controls[i];
+			msgs[i].msg_hdr.msg_controllen = CONTROL_LENGTH;
+		}
+	}
+
+	int ret = ::recvmmsg(m_fd, msgs, count, MSG_DONTWAIT, nullptr);
+	if (ret < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return 0;
+
+		if (errno == ECONNREFUSED && m_connected)
+			return 0;
+
+		LogError("Error returned from recvmmsg, err: %d", errno);
+
+		if (errno == ENOTSOCK) {
+			LogMessage("Re-opening UDP port on %hu", m_localPort);
+			close();
+			open();
+		}
+
+		return -1;
+	}
+
+	for (int i = 0; i < ret; i++) {
+		lengths[i] = msgs[i].msg_len;
+		if (timestamps != nullptr)
+			timestamps[i] = getTimestamp(&msgs[i].msg_hdr);
+	}
+
+	return ret;
+#else
+	unsigned int n = 0U;
+	while (n < count) {
+		unsigned int addressLength;
+		int ret = read(buffer + n * length, length, addresses[n], addressLength);
+		if (ret < 0)
+			return (n > 0U) ? int(n) : -1;
+		if (ret == 0)
+			break;
+
+		if (timestamps != nullptr)
+			timestamps[n] = 0ULL;
+
+		lengths[n++] = ret;
+	}
+
+	return int(n);
+#endif
+}
+
 bool CUDPSocket::write(const unsigned char* buffer, unsigned int length, const sockaddr_storage& address, unsigned int addressLength)
 {
 	assert(buffer != nullptr);
@@ -312,9 +672,17 @@ bool CUDPSocket::write(const unsigned char* buffer, unsigned int length, const s
 	bool result = false;
 
 #if defined(_WIN32) || defined(_WIN64)
-	int ret = ::sendto(m_fd, (char *)buffer, length, 0, (sockaddr *)&address, addressLength);
+	int ret = m_connected ? ::send(m_fd, (char *)buffer, length, 0) : ::sendto(m_fd, (char *)buffer, length, 0, (sockaddr *)&address, addressLength);
 #else
-	ssize_t ret = ::sendto(m_fd, (char *)buffer, length, 0, (sockaddr *)&address, addressLength);
+	ssize_t ret = m_connected ? ::send(m_fd, (char *)buffer, length, 0) : ::sendto(m_fd, (char *)buffer, length, 0, (sockaddr *)&address, addressLength);
+
+	// The error was left by an earlier datagram to an unreachable peer, this one wasn't sent
+	if (ret < 0 && errno == ECONNREFUSED && m_connected && m_af != AF_UNIX)
+		ret = ::send(m_fd, (char *)buffer, length, 0);
+
+	// As a datagram to a UDP port that nobody has open would be, it is lost without an error
+	if (ret < 0 && isPeerMissing(errno))
+		return true;
 #endif
 
 	if (ret < 0) {
@@ -336,18 +704,140 @@ bool CUDPSocket::write(const unsigned char* buffer, unsigned int length, const s
 	return result;
 }
 
+// Hold a datagram back until flush() is called, so that everything written to the socket during one
+// pass of the main loop goes out in a single sendmmsg() call. Elsewhere it is written immediately.
+bool CUDPSocket::queue(const unsigned char* buffer, unsigned int length, const sockaddr_storage& address, unsigned int addressLength)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+
+#if defined(__linux__)
+	if (length > QUEUE_SLOT_LENGTH) {
+		if (!flush())
+			return false;
+
+		return write(buffer, length, address, addressLength);
+	}
+
+	if (m_txBuffer == nullptr) {
+		m_txBuffer         = new unsigned char[MAX_QUEUE_LENGTH * QUEUE_SLOT_LENGTH];
+		m_txLengths        = new unsigned int[MAX_QUEUE_LENGTH];
+		m_txAddresses      = new sockaddr_storage[MAX_QUEUE_LENGTH];
+		m_txAddressLengths = new unsigned int[MAX_QUEUE_LENGTH];
+	}
+
+	if (m_txCount == MAX_QUEUE_LENGTH) {
+		if (!flush())
+			return false;
+	}
+
+	::memcpy(m_txBuffer + m_txCount * QUEUE_SLOT_LENGTH, buffer, length);
+	::memcpy(&m_txAddresses[m_txCount], &address, sizeof(sockaddr_storage));
+	m_txLengths[m_txCount]        = length;
+	m_txAddressLengths[m_txCount] = addressLength;
+	m_txCount++;
+
+	return true;
+#else
+	return write(buffer, length, address, addressLength);
+#endif
+}
+
+bool CUDPSocket::flush()
+{
+#if defined(__linux__)
+	if (m_txCount == 0U)
+		return true;
+
+	if (m_fd == -1) {
+		m_txCount = 0U;
+		return false;
+	}
+
+#if defined(USE_IO_URING)
+	if (m_ring != nullptr) {
+		bool ret = m_ring->write(m_txBuffer, QUEUE_SLOT_LENGTH, m_txCount, m_txLengths, m_connected ? nullptr : m_txAddresses, m_txAddressLengths);
+		m_txCount = 0U;
+		return ret;
+	}
+#endif
+
+	struct mmsghdr msgs[MAX_QUEUE_LENGTH];
+	struct iovec   iovecs[MAX_QUEUE_LENGTH];
+	::memset(msgs, 0x00U, m_txCount * sizeof(struct mmsghdr));
+
+	for (unsigned int i = 0U; i < m_txCount; i++) {
+		iovecs[i].iov_base = m_txBuffer + i * QUEUE_SLOT_LENGTH;
+		iovecs[i].iov_len  = m_txLengths[i];
+
+		if (!m_connected) {
+			msgs[i].msg_hdr.msg_name    = &m_txAddresses[i];
+			msgs[i].msg_hdr.msg_namelen = m_txAddressLengths[i];
+		}
+		msgs[i].msg_hdr.msg_iov     = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen  = 1U;
+	}
+
+	int flags = 0;
+
+	unsigned int sent = 0U;
+	while (sent < m_txCount) {
+		int ret = ::sendmmsg(m_fd, msgs + sent, m_txCount - sent, flags);
+		if (ret < 0) {
+			// As in write(), the datagram that picked up the error is sent again
+			if (errno == EINTR || (errno == ECONNREFUSED && m_connected && m_af != AF_UNIX))
+				continue;
+
+			// As a datagram to a UDP port that nobody has open would be, it is lost. Once a send
+			// has timed out on a stalled peer the rest of the batch doesn't wait.
+			if (isPeerMissing(errno)) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+					flags = MSG_DONTWAIT;
+				sent++;
+				continue;
+			}
+
+			LogError("Error returned from sendmmsg, err: %d", errno);
+			m_txCount = 0U;
+			return false;
+		}
+
+		sent += ret;
+	}
+
+	m_txCount = 0U;
+#endif
+	return true;
+}
+
 void CUDPSocket::close()
 {
 #if defined(_WIN32) || defined(_WIN64)
 	if (m_fd != INVALID_SOCKET) {
+		setPolling(false);
 		::closesocket(m_fd);
 		m_fd = INVALID_SOCKET;
 	}
 #else
+#if defined(__linux__)
+	flush();
+#endif
+
 	if (m_fd >= 0) {
+		setPolling(false);
+#if defined(USE_IO_URING) && defined(__linux__)
+		delete m_ring;
+		m_ring = nullptr;
+#endif
 		::close(m_fd);
 		m_fd = -1;
+
+		if (m_af == AF_UNIX)
+			::unlink(m_localAddress.c_str());
 	}
 #endif
+
+	// A socket opened again is no longer connected, until connect() is called on it once more
+	m_connected = false;
 }
 
@@ -30,11 +30,17 @@
 #include <unistd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 #include <errno.h>
 #else
 #include <ws2tcpip.h>
 #endif
 
+class CPoller;
+#if defined(USE_IO_URING) && defined(__linux__)
+class CIOURing;
+#endif
+
 enum class IPMATCHTYPE {
 	ADDRESS_AND_PORT,
 	ADDRESS_ONLY
@@ -49,9 +55,20 @@ public:
 	bool open();
 	bool open(const sockaddr_storage& address);
 
+	void setPoller(CPoller* poller);
+
+	void setPolling(bool polling);
+
+	bool connect(const sockaddr_storage& address, unsigned int addressLength);
+	bool isConnected() const;
+
 	int  read(unsigned char* buffer, unsigned int length, sockaddr_storage& address, unsigned int &addressLength);
+	int  read(unsigned char* buffer, unsigned int length, unsigned int count, unsigned int* lengths, sockaddr_storage* addresses, unsigned long long* timestamps = nullptr);
 	bool write(const unsigned char* buffer, unsigned int length, const sockaddr_storage& address, unsigned int addressLength);
 
+	bool queue(const unsigned char* buffer, unsigned int length, const sockaddr_storage& address, unsigned int addressLength);
+	bool flush();
+
 	void close();
 
 	static void startup();
@@ -60,6 +77,8 @@ public:
 	static int lookup(const std::string& hostName, unsigned short port, sockaddr_storage& address, unsigned int& addressLength);
 	static int lookup(const std::string& hostName, unsigned short port, sockaddr_storage& address, unsigned int& addressLength, struct addrinfo& hints);
 
+	static int lookupUnix(const std::string& path, sockaddr_storage& address, unsigned int& addressLength);
+
 	static bool match(const sockaddr_storage& addr1, const sockaddr_storage& addr2, IPMATCHTYPE type = IPMATCHTYPE::ADDRESS_AND_PORT);
 
 	static bool isNone(const sockaddr_storage& addr);
@@ -73,6 +92,30 @@ private:
 #else
 	int            m_fd;
 	sa_family_t    m_af;
+#endif
+	bool           m_connected;
+#if defined(__linux__)
+	unsigned char*    m_txBuffer;
+	unsigned int*     m_txLengths;
+	sockaddr_storage* m_txAddresses;
+	unsigned int*     m_txAddressLengths;
+	unsigned int      m_txCount;
+#endif
+#if defined(USE_IO_URING) && defined(__linux__)
+	CIOURing*         m_ring;
+#endif
+	CPoller*       m_poller;
+	bool           m_polled;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	bool openUnix();
+	bool isPeerMissing(int err) const;
+#endif
+	bool setup();
+#if defined(_WIN32) || defined(_WIN64)
+	SOCKET getPollFd() const;
+#else
+	int    getPollFd() const;
 #endif
 };
 
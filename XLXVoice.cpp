@@ -23,6 +23,7 @@
 #include "Sync.h"
 #include "Log.h"
 
+#include <cassert>
 #include <cstring>
 #include <cstdlib>
 
@@ -35,7 +36,7 @@ const unsigned char COLOR_CODE = 3U;
 const unsigned int SILENCE_LENGTH = 9U;
 const unsigned int AMBE_LENGTH = 9U;
 
-CXLXVoice::CXLXVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg) :
+CXLXVoice::CXLXVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg, CDMRDataPool* pool) :
 m_indxFile(),
 m_ambeFile(),
 m_slot(slot),
@@ -48,10 +49,14 @@ m_seqNo(0U),
 m_streamId(0U),
 m_sent(0U),
 m_ambe(nullptr),
+m_ambeData(),
 m_positions(),
+m_pool(pool),
 m_data(),
 m_it()
 {
+	assert(pool != nullptr);
+
 	m_embeddedLC.setLC(m_lc);
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -65,13 +70,11 @@ m_it()
 
 CXLXVoice::~CXLXVoice()
 {
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete *it;
+	m_pool->put(m_data);
 
 	for (std::unordered_map<std::string, CXLXPositions*>::iterator it = m_positions.begin(); it != m_positions.end(); ++it)
 		delete it->second;
 
-	m_data.clear();
 	m_positions.clear();
 
 	delete[] m_ambe;
@@ -186,7 +189,8 @@ void CXLXVoice::createVoice(const std::vector<std::string>& words)
 	ambeLength += SILENCE_LENGTH * AMBE_LENGTH;
 	ambeLength += SILENCE_LENGTH * AMBE_LENGTH;
 
-	unsigned char* ambeData = new unsigned char[ambeLength];
+	m_ambeData.resize(ambeLength);
+	unsigned char* ambeData = m_ambeData.data();
 
 	// Fill the AMBE data with silence
 	for (unsigned int i = 0U; i < ambeLength; i += AMBE_LENGTH)
@@ -204,10 +208,7 @@ void CXLXVoice::createVoice(const std::vector<std::string>& words)
 		}
 	}
 		
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete *it;
-
-	m_data.clear();
+	m_pool->put(m_data);
 
 	m_streamId = ::rand() + 1U;
 	m_seqNo = 0U;
@@ -222,7 +223,7 @@ void CXLXVoice::createVoice(const std::vector<std::string>& words)
 	for (unsigned int i = 0U; i < ambeLength; i += (3U * AMBE_LENGTH)) {
 		unsigned char* p = ambeData + i;
 
-		CDMRData* data = new CDMRData;
+		CDMRData* data = m_pool->get();
 
 		data->setSlotNo(m_slot);
 		data->setFLCO(FLCO::GROUP);
@@ -264,20 +265,16 @@ void CXLXVoice::createVoice(const std::vector<std::string>& words)
 	createHeaderTerminator(DT_TERMINATOR_WITH_LC);
 	createHeaderTerminator(DT_TERMINATOR_WITH_LC);
 
-	delete[] ambeData;
-
 	m_status = XLXVOICE_STATUS::WAITING;
 	m_timer.start();
 }
 
 void CXLXVoice::reset()
 {
-	for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-		delete *it;
+	m_pool->put(m_data);
 
 	m_timer.stop();
 	m_status = XLXVOICE_STATUS::NONE;
-	m_data.clear();
 	m_seqNo = 0U;
 	m_streamId = 0U;
 	m_sent = 0U;
@@ -297,9 +294,7 @@ bool CXLXVoice::read(CDMRData& data)
 		++m_it;
 
 		if (m_it == m_data.end()) {
-			for (std::vector<CDMRData*>::iterator it = m_data.begin(); it != m_data.end(); ++it)
-				delete *it;
-			m_data.clear();
+			m_pool->put(m_data);
 			m_timer.stop();
 			m_status = XLXVOICE_STATUS::NONE;
 		}
@@ -310,6 +305,11 @@ bool CXLXVoice::read(CDMRData& data)
 	return false;
 }
 
+bool CXLXVoice::isBusy() const
+{
+	return m_status != XLXVOICE_STATUS::NONE;
+}
+
 void CXLXVoice::clock(unsigned int ms)
 {
 	m_timer.clock(ms);
@@ -325,7 +325,7 @@ void CXLXVoice::clock(unsigned int ms)
 
 void CXLXVoice::createHeaderTerminator(unsigned char type)
 {
-	CDMRData* data = new CDMRData;
+	CDMRData* data = m_pool->get();
 
 	data->setSlotNo(m_slot);
 	data->setFLCO(FLCO::GROUP);
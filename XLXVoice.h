@@ -20,6 +20,7 @@
 #define	XLXVoice_H
 
 #include "DMREmbeddedData.h"
+#include "DMRDataPool.h"
 #include "StopWatch.h"
 #include "DMRData.h"
 #include "DMRLC.h"
@@ -42,7 +43,7 @@ struct CXLXPositions {
 
 class CXLXVoice {
 public:
-	CXLXVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg);
+	CXLXVoice(const std::string& directory, const std::string& language, unsigned int id, unsigned int slot, unsigned int tg, CDMRDataPool* pool);
 	~CXLXVoice();
 
 	bool open();
@@ -54,6 +55,8 @@ public:
 
 	bool read(CDMRData& data);
 
+	bool isBusy() const;
+
 	void clock(unsigned int ms);
 
 private:
@@ -69,7 +72,9 @@ private:
 	unsigned int                           m_streamId;
 	unsigned int                           m_sent;
 	unsigned char*                         m_ambe;
+	std::vector<unsigned char>             m_ambeData;
 	std::unordered_map<std::string, CXLXPositions*> m_positions;
+	CDMRDataPool*                          m_pool;
 	std::vector<CDMRData*>                 m_data;
 	std::vector<CDMRData*>::const_iterator m_it;
 